@@ -1,20 +1,31 @@
 #include "capture_worker.h"
-#include <opencv2/imgproc.hpp>
 #include <thread>
 #include <iostream>
+#include "../core/trace.h"
 
-void CaptureWorker::run(SimpleCamera &cam, SafeQueue<cv::Mat> &frameQueue, std::atomic<bool> &running, uint32_t width, uint32_t height) {
+void CaptureWorker::run(FrameSource &source, Mailbox<FramePtr> &frameQueue, Mailbox<FramePtr> &palmQueue,
+                        std::atomic<bool> &palmWanted, std::atomic<bool> &running) {
+    traceThreadName("capture");
+    FramePtr frame;
     while (running.load()) {
-        LibcameraOutData fd;
-        if (!cam.readFrame(fd)) {
+        // An unpaced source (offline replay) waits until the consumers have
+        // taken the previous frame, so nothing is overwritten unseen.
+        if (!source.paced()) {
+            while (running.load() && (frameQueue.consumed() < frameQueue.published() ||
+                                      palmQueue.consumed() < palmQueue.published()))
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        uint64_t t0 = traceEnabled() ? traceNowNs() : 0;
+        if (!source.grab(frame)) {
+            if (source.finished()) break;
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
-        cv::Mat rawData((int)height, (int)width, CV_8UC3, fd.imageData);
-        cv::Mat safeFrame = rawData.clone();
-        cam.returnFrameBuffer(fd);
-
-        cv::flip(safeFrame, safeFrame, 1);
-        frameQueue.push(std::move(safeFrame));
+        if (t0) traceRecord("capture.grab", t0, traceNowNs());
+        // The palm stage only gets frames (and holds buffers) while it is needed.
+        if (palmWanted.load()) palmQueue.push(frame);
+        frameQueue.push(std::move(frame));
     }
+    frameQueue.stop();
+    palmQueue.stop();
 }
\ No newline at end of file
@@ -1,14 +1,14 @@
 #ifndef CAPTURE_WORKER_H
 #define CAPTURE_WORKER_H
 
-#include "../camera/camera.h"
+#include "../camera/frame_source.h"
 #include "../core/frame_buffer.h" 
-#include <opencv2/core.hpp>
 #include <atomic>
 
 class CaptureWorker {
 public:
-    void run(SimpleCamera &cam, SafeQueue<cv::Mat> &frameQueue, std::atomic<bool> &running, uint32_t width, uint32_t height);
+    void run(FrameSource &source, Mailbox<FramePtr> &frameQueue, Mailbox<FramePtr> &palmQueue,
+             std::atomic<bool> &palmWanted, std::atomic<bool> &running);
 };
 
 #endif
\ No newline at end of file
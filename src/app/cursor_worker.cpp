@@ -0,0 +1,81 @@
+#include "cursor_worker.h"
+#include "../core/clock.h"
+#include "../core/trace.h"
+#include <algorithm>
+#include <iostream>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+void CursorWorker::run(MouseController &mouse, Mailbox<cursor_target_t> &targetQueue, std::atomic<bool> &running) {
+    traceThreadName("cursor");
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0) {
+        std::cerr << "ERR: timerfd_create failed, cursor output disabled\n";
+        return;
+    }
+    const long period_ns = 1000000000L / std::max(rateHz, 1);
+    struct itimerspec its = {};
+    its.it_interval.tv_sec = period_ns / 1000000000L;
+    its.it_interval.tv_nsec = period_ns % 1000000000L;
+    its.it_value = its.it_interval;
+    timerfd_settime(tfd, 0, &its, nullptr);
+
+    prev_ = last_ = cursor_target_t();
+    while (running.load()) {
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+
+        cursor_target_t t;
+        bool fresh = false;
+        while (targetQueue.try_pop(t)) fresh = true;
+        if (fresh) {
+            if (!t.active || !last_.active) prev_ = t;
+            else prev_ = last_;
+            last_ = t;
+            last_arrival_ns_ = monotonicNowNs();
+        } else if (targetQueue.stopped()) {
+            break;
+        }
+
+        TRACE_SPAN("cursor.emit");
+        apply(mouse, last_);
+        mouse.flush();
+    }
+    if (left_down_) mouse.release_left();
+    mouse.flush();
+    close(tfd);
+}
+
+fvec2 CursorWorker::position(uint64_t now_ns) const {
+    if (predict) {
+        double lead = now_ns > last_.timestamp_ns ? (now_ns - last_.timestamp_ns) * 1e-9 : 0.0;
+        lead = std::min(lead, CURSOR_MAX_LEAD_MS * 1e-3);
+        return {last_.x + last_.vx * (float)lead, last_.y + last_.vy * (float)lead};
+    }
+    // Measured targets arrive one target interval apart; cover it in that time.
+    double interval = last_.timestamp_ns > prev_.timestamp_ns ? (last_.timestamp_ns - prev_.timestamp_ns) * 1e-9 : 0.0;
+    double elapsed = now_ns > last_arrival_ns_ ? (now_ns - last_arrival_ns_) * 1e-9 : 0.0;
+    float a = interval > 0.0 ? (float)std::min(elapsed / interval, 1.0) : 1.0f;
+    return {prev_.x + (last_.x - prev_.x) * a, prev_.y + (last_.y - prev_.y) * a};
+}
+
+void CursorWorker::apply(MouseController &mouse, const cursor_target_t &t) {
+    if (!t.active) {
+        // A lost hand must not leave the button held.
+        if (left_down_) { mouse.release_left(); left_down_ = false; }
+        right_down_ = false;
+        return;
+    }
+    fvec2 p = position(monotonicNowNs());
+    int x = std::min(std::max((int)p.x, 0), SCREEN_WIDTH);
+    int y = std::min(std::max((int)p.y, 0), SCREEN_HEIGHT);
+    mouse.move_absolute(x, y);
+
+    if (t.left_down != left_down_) {
+        if (t.left_down) mouse.press_left();
+        else mouse.release_left();
+        left_down_ = t.left_down;
+    }
+    if (t.right_down && !right_down_) mouse.click_right();
+    right_down_ = t.right_down;
+}
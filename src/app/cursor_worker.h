@@ -0,0 +1,33 @@
+#ifndef CURSOR_WORKER_H
+#define CURSOR_WORKER_H
+
+#include "../core/types.h"
+#include "../core/frame_buffer.h"
+#include "../mouse/mouse_control.h"
+#include <atomic>
+
+// Owns the uinput mouse and moves it at a fixed rate from a timerfd, between
+// and beyond the targets the inference thread publishes, so the cursor is
+// smooth at display rate and does not stall with inference. Each tick's
+// events go out in one flush.
+class CursorWorker {
+public:
+    void run(MouseController &mouse, Mailbox<cursor_target_t> &targetQueue, std::atomic<bool> &running);
+
+    int rateHz = CURSOR_OUTPUT_HZ;
+    // Extrapolate the newest target to the current time (up to
+    // CURSOR_MAX_LEAD_MS past its capture); otherwise glide from the previous
+    // target to the newest over one target interval.
+    bool predict = true;
+
+private:
+    fvec2 position(uint64_t now_ns) const;
+    void apply(MouseController &mouse, const cursor_target_t &t);
+
+    cursor_target_t prev_, last_;
+    uint64_t last_arrival_ns_ = 0;
+    bool left_down_ = false;
+    bool right_down_ = false;
+};
+
+#endif
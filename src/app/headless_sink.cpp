@@ -0,0 +1,110 @@
+#include "headless_sink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "../core/trace.h"
+#include "../core/clock.h"
+#if ALLOC_STATS
+#include "../core/alloc_count.h"
+#endif
+
+namespace {
+struct Window {
+    uint64_t frames = 0, tracking = 0, palm_runs = 0, hand_rois = 0, hand_reused = 0;
+    double palm_ms = 0.0, hand_ms = 0.0, palm_duty = 0.0;
+#if ALLOC_STATS
+    uint64_t allocs_start = heapAllocCount();
+#endif
+
+    void add(const detection_output_t &out) {
+        frames++;
+        if (out.is_tracking) tracking++;
+        if (out.palm_time_ms > 0.0) { palm_runs++; palm_ms += out.palm_time_ms; }
+        hand_ms += out.hand_time_ms;
+        hand_rois += out.hand_rois;
+        hand_reused += out.hand_reused;
+        palm_duty += out.palm_duty;
+    }
+#if ALLOC_STATS
+    double allocsPerFrame() const { return frames ? (double)(heapAllocCount() - allocs_start) / frames : 0.0; }
+#else
+    double allocsPerFrame() const { return 0.0; }
+#endif
+    void print(const char *tag, double sec) const {
+        printf("%s %llu frames in %.1fs: %.1f fps, tracking %.0f%%, palm %.1fms (x%llu, duty %.0f%%), hand %.1fms (reused %.0f%%)",
+               tag, (unsigned long long)frames, sec, sec > 0 ? frames / sec : 0.0,
+               frames ? 100.0 * tracking / frames : 0.0,
+               palm_runs ? palm_ms / palm_runs : 0.0, (unsigned long long)palm_runs,
+               frames ? 100.0 * palm_duty / frames : 0.0, frames ? hand_ms / frames : 0.0,
+               hand_rois ? 100.0 * hand_reused / hand_rois : 0.0);
+#if ALLOC_STATS
+        printf(", %.1f allocs/frame", allocsPerFrame());
+#endif
+        printf("\n");
+        fflush(stdout);
+    }
+};
+}
+
+static double percentile(const uint32_t *hist, int bins, uint64_t count, double q) {
+    if (!count) return 0.0;
+    uint64_t rank = (uint64_t)(q * (count - 1)), seen = 0;
+    for (int i = 0; i < bins; ++i) {
+        seen += hist[i];
+        if (seen > rank) return i + 0.5;
+    }
+    return bins;
+}
+
+void HeadlessSink::run(Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &running) {
+    Window total, window;
+    auto start = std::chrono::steady_clock::now();
+    auto window_start = start;
+    auto measure_start = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double>(warmupSec));
+    bool measuring = warmupSec <= 0.0;
+    uint64_t latency_count = 0;
+    memset(latency_hist_, 0, sizeof(latency_hist_));
+
+    traceThreadName("render");
+    detection_output_t out;
+    while (running.load()) {
+        {
+            TRACE_SPAN("render.wait");
+            if (!outputQueue.pop(out)) break;
+        }
+        out.frame.reset();
+        auto now = std::chrono::steady_clock::now();
+        if (!measuring && now >= measure_start) {
+            measuring = true;
+            total = Window();
+            start = now;
+        }
+        total.add(out);
+        window.add(out);
+        if (measuring && measureLatency) {
+            uint64_t t = monotonicNowNs();
+            int ms = t > out.timestamp_ns ? (int)((t - out.timestamp_ns) / 1000000) : 0;
+            latency_hist_[ms < kLatencyBins ? ms : kLatencyBins - 1]++;
+            latency_count++;
+        }
+
+        double sec = std::chrono::duration<double>(now - window_start).count();
+        if (sec >= 1.0) {
+            if (!quiet) window.print("[headless]", sec);
+            window = Window();
+            window_start = now;
+        }
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!quiet) total.print("[headless] total:", sec);
+
+    stats_ = pipeline_stats_t();
+    stats_.frames = total.frames;
+    stats_.seconds = sec;
+    stats_.fps = sec > 0 ? total.frames / sec : 0.0;
+    stats_.latency_p50_ms = percentile(latency_hist_, kLatencyBins, latency_count, 0.50);
+    stats_.latency_p95_ms = percentile(latency_hist_, kLatencyBins, latency_count, 0.95);
+    stats_.hand_ms = total.frames ? total.hand_ms / total.frames : 0.0;
+    stats_.allocs_per_frame = total.allocsPerFrame();
+}
@@ -0,0 +1,26 @@
+#ifndef HEADLESS_SINK_H
+#define HEADLESS_SINK_H
+
+#include "../core/types.h"
+#include "../core/frame_buffer.h"
+#include <atomic>
+
+// Stand-in for Renderer when there is no display: drains the results and
+// prints throughput and stage timings once a second and at the end.
+class HeadlessSink {
+public:
+    void run(Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &running);
+    // Totals of the last run, excluding the warm-up.
+    pipeline_stats_t stats() const { return stats_; }
+
+    double warmupSec = 0.0;     // results in the first warmupSec are not counted
+    bool measureLatency = true; // capture timestamps are on the monotonic clock
+    bool quiet = false;         // no per-second lines
+
+private:
+    static const int kLatencyBins = 1000;   // 1 ms each, the last one open
+    uint32_t latency_hist_[kLatencyBins];
+    pipeline_stats_t stats_;
+};
+
+#endif
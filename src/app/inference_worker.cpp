@@ -1,113 +1,180 @@
 #include "inference_worker.h"
-#include "../tracking/roi_tracker.h"
-#include <opencv2/imgproc.hpp>
+#include "../tracking/hand_tracker.h"
 #include <chrono>
 #include <cmath>
+#include <algorithm>
+#include <cstring>
+#include "../core/trace.h"
+
+// Landmark ROIs and results of one frame, before tracking drops any.
+static void logHands(landmark_log_record_t &rec, const HandTracker &tracker, const std::vector<HandRoi> &rois,
+                     const std::vector<hand_landmark_result_t> &results) {
+    const size_t n = std::min(std::min(rois.size(), results.size()), (size_t)MAX_HAND_NUM);
+    for (size_t i = 0; i < n; ++i) {
+        landmark_log_hand_t &h = rec.hands[i];
+        h.track_id = tracker.tracks()[i].id;
+        h.score = results[i].score;
+        h.roi = rois[i];
+        memcpy(h.joint, results[i].joint, sizeof(h.joint));
+    }
+    rec.hand_count = (uint8_t)n;
+}
 
-void InferenceWorker::run(PALM &palm_detector, HandLandmark &landmark_detector, MouseController &mouse, 
-             SafeQueue<cv::Mat> &inputQueue, SafeQueue<detection_output_t> &outputQueue, 
-             std::atomic<bool> &running, uint32_t width, uint32_t height) 
+void InferenceWorker::run(HandLandmark &landmark_detector, Mailbox<cursor_target_t> &cursorQueue,
+             Mailbox<FramePtr> &inputQueue, Mailbox<palm_candidates_t> &palmQueue,
+             Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &palmWanted,
+             std::atomic<int> &trackedHands, std::atomic<bool> &running, uint32_t width, uint32_t height) 
 {
-    HandRoi current_roi;
-    current_roi.isValid = false;
-
-    cv::Mat frame;
+    HandTracker tracker;
+    std::vector<HandRoi> rois;
+    std::vector<hand_landmark_result_t> hand_results;
+    uint64_t search_start_seq = 0;
+    float palm_duty = 0.0f;
+    palmWanted.store(true);
+    trackedHands.store(0);
+    resetCursor();
+
+    traceThreadName("inference");
+    FramePtr frame;
     while (running.load()) {
-        if (!inputQueue.pop(frame)) break;
-        if (frame.empty()) continue;
+        {
+            TRACE_SPAN("inference.wait");
+            if (!inputQueue.pop(frame)) break;
+        }
+        if (!frame || frame->image.empty()) continue;
 
         detection_output_t out_data;
-        out_data.frame = frame.clone();
+        if (attachFrames) out_data.frame = frame;
+        out_data.timestamp_ns = frame->timestamp_ns;
         out_data.is_tracking = false;
         out_data.palm_time_ms = 0.0;
         out_data.hand_time_ms = 0.0;
+        out_data.hand_count = 0;
+        out_data.hand_rois = 0;
+        out_data.hand_reused = 0;
+        out_data.palm_duty = 0.0f;
+        landmark_log_record_t rec{};   // zeroed, padding too, so the file is deterministic
+
+        // --- 1. NEW HANDS FROM THE PALM STAGE ---
+        // The palm stage runs on its own thread while there is room for another
+        // hand; pick up its latest candidates if there are any and keep going.
+        if (!tracker.full()) {
+            if (!palmWanted.load()) {
+                search_start_seq = frame->sequence;
+                palmWanted.store(true);
+            }
+            palm_candidates_t cand;
+            if (palmQueue.try_pop(cand) && cand.frame_sequence >= search_start_seq) {
+                TRACE_SPAN("tracking.add_candidates");
+                out_data.palm_time_ms = cand.palm_time_ms;
+                palm_duty = cand.palm_duty;
+                tracker.addCandidates(cand.result, width, height);
+            }
+            out_data.palm_duty = palm_duty;
+        }
 
-        std::vector<hand_landmark_result_t> hand_results;
-        bool hand_found = false;
-
-        // --- 1. TRACKING MODE ---
-        if (current_roi.isValid) {
+        // --- 2. TRACKING: every ROI through one batched landmark Invoke ---
+        hand_results.clear();
+        tracker.collectRois(rois);
+        if (!rois.empty()) {
             auto t1 = std::chrono::high_resolution_clock::now();
-            landmark_detector.run(frame, hand_results, current_roi, width, height);
+            landmark_detector.run(*frame, rois, hand_results, width, height);
             auto t2 = std::chrono::high_resolution_clock::now();
             out_data.hand_time_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
-
-            if (!hand_results.empty()) {
-                float score = hand_results[0].score;
-                if (score > THRESH_TRACK_EXIT) {
-                    hand_found = true;
-                    out_data.is_tracking = true;
-                    if (score > 0.5f) {
-                        HandRoi raw_roi;
-                        RoiTracker::calculateRoiFromLandmarks(hand_results[0], raw_roi, width, height);
-                        current_roi = raw_roi;
-                        processMouseLogic(mouse, hand_results[0], width, height);
-                    }
-                } else {
-                    current_roi.isValid = false;
-                }
-            } else {
-                current_roi.isValid = false;
-            }
+            out_data.hand_rois = (int)rois.size();
+            out_data.hand_reused = landmark_detector.reusedCount();
+            if (log) logHands(rec, tracker, rois, hand_results);
+            TRACE_SPAN("tracking.update");
+            tracker.update(hand_results, width, height);
+        }
+        trackedHands.store(tracker.count());
+        if (tracker.full()) palmWanted.store(false);
+
+        const HandTrack *primary = tracker.primary();
+        const int primary_id = primary ? primary->id : -1;
+        out_data.is_tracking = primary != nullptr;
+        updateCursor(hand_results.data(), (int)hand_results.size(), primary_id, width, height,
+                     frame->timestamp_ns, cursorQueue);
+
+        for (const auto &res : hand_results) {
+            if (out_data.hand_count == MAX_HAND_NUM) break;
+            out_data.hand_results[out_data.hand_count++] = res;
+        }
+        if (log) {
+            rec.timestamp_ns = frame->timestamp_ns;
+            rec.sequence = frame->sequence;
+            rec.palm_ms = (float)out_data.palm_time_ms;
+            rec.hand_ms = (float)out_data.hand_time_ms;
+            rec.palm_duty = out_data.palm_duty;
+            rec.primary_id = primary_id;
+            rec.hand_reused = (uint8_t)out_data.hand_reused;
+            log->append(rec);
         }
+        outputQueue.push(std::move(out_data));
+    }
+    outputQueue.stop();
+    cursorQueue.stop();
+}
 
-        // --- 2. DETECTION MODE (PALM) ---
-        if (!hand_found) {
-            cv::Mat normalizedImg;
-            cv::Mat rgb;
-            cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
-            rgb.convertTo(normalizedImg, CV_32FC3, 1.0f / 255.0f);
+void InferenceWorker::resetCursor() {
+    cursor_filter = makeCursorFilter(cursorFilter);
+    cursor_hand_id = -1;
+    cursor_active = false;
+}
 
-            palm_detection_result_t palm_result;
-            auto t1 = std::chrono::high_resolution_clock::now();
-            palm_detector.run(normalizedImg, palm_result);
-            auto t2 = std::chrono::high_resolution_clock::now();
-            out_data.palm_time_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
-
-            if (palm_result.num > 0) {
-                const auto& p = palm_result.palms[0];
-                HandRoi roi_from_palm;
-                roi_from_palm.xc = p.hand_cx; roi_from_palm.yc = p.hand_cy;
-                roi_from_palm.w = p.hand_w; roi_from_palm.h = p.hand_h;
-                roi_from_palm.rotation = p.rotation; roi_from_palm.isValid = true;
-
-                auto t3 = std::chrono::high_resolution_clock::now();
-                landmark_detector.run(frame, hand_results, roi_from_palm, width, height);
-                auto t4 = std::chrono::high_resolution_clock::now();
-                out_data.hand_time_ms += std::chrono::duration<double, std::milli>(t4 - t3).count();
-
-                if (!hand_results.empty() && hand_results[0].score > THRESH_TRACK_ENTER) {
-                    HandRoi raw_roi;
-                    RoiTracker::calculateRoiFromLandmarks(hand_results[0], raw_roi, width, height);
-                    current_roi = raw_roi;
-                }
+void InferenceWorker::updateCursor(const hand_landmark_result_t *results, int count, int primary_id,
+                                   uint32_t width, uint32_t height, uint64_t frame_ts_ns,
+                                   Mailbox<cursor_target_t> &cursorQueue) {
+    // Filter state belongs to one hand; start over when the cursor hand changes.
+    if (primary_id != cursor_hand_id) {
+        cursor_filter->reset();
+        cursor_hand_id = primary_id;
+    }
+    if (primary_id >= 0) {
+        for (int i = 0; i < count; ++i) {
+            const hand_landmark_result_t &res = results[i];
+            if (res.hand_id == primary_id && res.score > 0.5f) {
+                TRACE_SPAN("mouse.target");
+                cursorQueue.push(processMouseLogic(res, width, height, frame_ts_ns));
+                cursor_active = true;
             }
         }
-        out_data.hand_results = hand_results;
-        outputQueue.push(std::move(out_data));
+    } else if (cursor_active) {
+        cursorQueue.push(cursor_target_t());
+        cursor_active = false;
     }
 }
 
-void InferenceWorker::processMouseLogic(MouseController &mouse, const hand_landmark_result_t &res, uint32_t width, uint32_t height) {
+cursor_target_t InferenceWorker::processMouseLogic(const hand_landmark_result_t &res, uint32_t width, uint32_t height,
+                                                   uint64_t frame_ts_ns) {
     const float region_w = (float)MOUSE_REGION_W;
     const float region_h = (float)MOUSE_REGION_H;
     const float offset_x = (width - region_w) / 2.0f;
     const float offset_y = (height - region_h) / 2.0f;
-
-    float hx = res.joint[9].x;
-    float hy = res.joint[9].y;
+    const float sx = SCREEN_WIDTH / region_w;
+    const float sy = SCREEN_HEIGHT / region_h;
+
+    fvec2 p = {res.joint[9].x, res.joint[9].y};
+    fvec2 v = {0.0f, 0.0f};
+    if (cursor_filter) {
+        p = cursor_filter->update(p, frame_ts_ns * 1e-9);
+        v = cursor_filter->velocity();
+    }
+    float hx = p.x;
+    float hy = p.y;
 
     if (hx < offset_x) hx = offset_x;
     if (hx > offset_x + region_w) hx = offset_x + region_w;
     if (hy < offset_y) hy = offset_y;
     if (hy > offset_y + region_h) hy = offset_y + region_h;
 
-    float x_norm = (hx - offset_x) / region_w;
-    float y_norm = (hy - offset_y) / region_h;
-
-    int abs_x = (int)(x_norm * SCREEN_WIDTH);
-    int abs_y = (int)(y_norm * SCREEN_HEIGHT);
-    mouse.move_absolute(abs_x, abs_y);
+    cursor_target_t t;
+    t.active = true;
+    t.x = (hx - offset_x) * sx;
+    t.y = (hy - offset_y) * sy;
+    t.vx = v.x * sx;
+    t.vy = v.y * sy;
+    t.timestamp_ns = frame_ts_ns;
 
     // Tính toán ngưỡng click dựa trên kích thước bàn tay
     float scale_dist = std::sqrt(std::pow(res.joint[5].x - res.joint[9].x, 2) + std::pow(res.joint[5].y - res.joint[9].y, 2));
@@ -119,26 +186,8 @@ void InferenceWorker::processMouseLogic(MouseController &mouse, const hand_landm
     // Khoảng cách ngón cái (4) và gốc ngón trỏ (6) -> Click Phải
     float d_right = std::sqrt(std::pow(res.joint[4].x - res.joint[6].x, 2) + std::pow(res.joint[4].y - res.joint[6].y, 2));
 
-    
-    if (d_left < click_thresh) {
-        if (!is_clicking_left) {
-            mouse.press_left();      
-            is_clicking_left = true;  
-        }
-    } 
-    else {
-        if (is_clicking_left) {
-            mouse.release_left();     
-            is_clicking_left = false; 
-        }
-    }
-
-    if (!is_clicking_left && d_right < click_thresh) {
-        if (!is_clicking_right) {
-            mouse.click_right();
-            is_clicking_right = true;
-        }
-    } else {
-        is_clicking_right = false;
-    }
-}
\ No newline at end of file
+    // Buttons are pressed and released on the cursor thread, on state changes.
+    t.left_down = d_left < click_thresh;
+    t.right_down = !t.left_down && d_right < click_thresh;
+    return t;
+}
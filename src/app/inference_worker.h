@@ -3,20 +3,41 @@
 
 #include "../core/types.h"
 #include "../core/frame_buffer.h"
-#include "../models/palm.h"
+#include "../core/landmark_log.h"
 #include "../models/hand_landmark.h"
-#include "../mouse/mouse_control.h"
+#include "../tracking/cursor_filter.h"
 #include <atomic>
+#include <memory>
 
 class InferenceWorker {
 public:
-    void run(PALM &palm_detector, HandLandmark &landmark_detector, MouseController &mouse, 
-             SafeQueue<cv::Mat> &inputQueue, SafeQueue<detection_output_t> &outputQueue, 
-             std::atomic<bool> &running, uint32_t width, uint32_t height);
+    // Cursor targets go to cursorQueue; CursorWorker turns them into mouse events.
+    void run(HandLandmark &landmark_detector, Mailbox<cursor_target_t> &cursorQueue,
+             Mailbox<FramePtr> &inputQueue, Mailbox<palm_candidates_t> &palmQueue,
+             Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &palmWanted,
+             std::atomic<int> &trackedHands, std::atomic<bool> &running, uint32_t width, uint32_t height);
+
+    CursorFilterType cursorFilter = CursorFilterType::ONE_EURO;
+    // Hand the frame on with the results (for the preview). Off when nothing
+    // draws, so the camera buffer goes back as soon as inference is done.
+    bool attachFrames = true;
+    // When set, every processed frame's landmark ROIs, results and timings
+    // are appended to it.
+    LandmarkLogWriter *log = nullptr;
+
+    // Cursor step for one frame: results of the tracked hands (hand_id set)
+    // and the id of the primary hand, -1 for none. Shared with log replay.
+    void updateCursor(const hand_landmark_result_t *results, int count, int primary_id,
+                      uint32_t width, uint32_t height, uint64_t frame_ts_ns, Mailbox<cursor_target_t> &cursorQueue);
+    void resetCursor();
+
 private:
-    void processMouseLogic(MouseController &mouse, const hand_landmark_result_t &res, uint32_t width, uint32_t height);
-    bool is_clicking_left = false;
-    bool is_clicking_right = false;
+    friend struct BenchAccess;
+    cursor_target_t processMouseLogic(const hand_landmark_result_t &res, uint32_t width, uint32_t height,
+                                      uint64_t frame_ts_ns);
+    std::unique_ptr<CursorFilter> cursor_filter;
+    int cursor_hand_id = -1;
+    bool cursor_active = false;
 };
 
 #endif
\ No newline at end of file
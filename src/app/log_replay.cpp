@@ -0,0 +1,74 @@
+#include "log_replay.h"
+#include "inference_worker.h"
+#include "cursor_worker.h"
+#include "../core/clock.h"
+#include "../core/landmark_log.h"
+#include "../mouse/mouse_control.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+bool LogReplay::run(const AppOptions &opt, const std::string &path) {
+    LandmarkLogReader reader;
+    if (!reader.open(path)) return false;
+    const landmark_log_header_t &h = reader.header();
+    const uint64_t n = reader.size();
+    if (!n) {
+        std::cerr << "Log Error: " << path << " holds no frames" << std::endl;
+        return false;
+    }
+    const bool realtime = opt.replay_realtime;
+    std::cout << "Replay: " << n << " frames of " << h.frame_width << "x" << h.frame_height << " from " << path
+              << (realtime ? "" : " (fast)") << "\n";
+
+    InferenceWorker worker;
+    worker.cursorFilter = opt.cursor_filter;
+    worker.resetCursor();
+    Mailbox<cursor_target_t> cursorBuf;
+    std::atomic<bool> running{true};
+
+    // Without init() the controller is a no-op sink.
+    MouseController mouse;
+    CursorWorker cursorWorker;
+    cursorWorker.rateHz = opt.cursor_hz;
+    cursorWorker.predict = opt.cursor_predict;
+    std::thread cursor;
+    if (realtime) {
+        if (opt.mouse && !mouse.init()) std::cerr << "WARNING: Mouse init failed. Run with sudo?\n";
+        cursor = std::thread(&CursorWorker::run, &cursorWorker, std::ref(mouse), std::ref(cursorBuf), std::ref(running));
+    }
+
+    // Records are stamped onto the current clock, keeping their spacing, so
+    // the cursor thread's prediction sees live-looking capture times.
+    const uint64_t first_ns = reader[0].timestamp_ns;
+    const uint64_t start_ns = monotonicNowNs();
+    const auto start = std::chrono::steady_clock::now();
+    hand_landmark_result_t results[MAX_HAND_NUM];
+    uint64_t hands = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        const landmark_log_record_t &rec = reader[i];
+        const uint64_t offset_ns = rec.timestamp_ns > first_ns ? rec.timestamp_ns - first_ns : 0;
+        if (realtime)
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::nanoseconds(offset_ns)));
+        const int count = landmarkLogResults(h, rec, results);
+        hands += count;
+        worker.updateCursor(results, count, rec.primary_id, h.frame_width, h.frame_height, start_ns + offset_ns,
+                            cursorBuf);
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The cursor thread drains the last target, then sees the stop.
+    cursorBuf.stop();
+    if (cursor.joinable()) cursor.join();
+    running.store(false);
+
+    std::cout << "Replay: " << n << " frames, " << hands << " hands, " << cursorBuf.published()
+              << " cursor targets in " << sec << " s";
+    if (!realtime && sec > 0.0) std::cout << " (" << (uint64_t)(n / sec) << " samples/s)";
+    std::cout << "\n";
+    if (mouse.writeErrors() || mouse.shortWrites())
+        std::cout << "Mouse: " << mouse.writeErrors() << " failed writes, " << mouse.shortWrites() << " short writes\n";
+    return true;
+}
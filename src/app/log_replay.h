@@ -0,0 +1,16 @@
+#ifndef LOG_REPLAY_H
+#define LOG_REPLAY_H
+
+#include "../core/app_options.h"
+#include <string>
+
+// --replay: feeds a --record log through the same cursor logic the inference
+// thread runs, without camera or models. Realtime pacing drives the mouse
+// through the cursor thread as the live pipeline would; --pace=fast runs the
+// cursor logic alone as fast as it goes and reports samples per second.
+class LogReplay {
+public:
+    bool run(const AppOptions &opt, const std::string &path);
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "palm_scheduler.h"
+#include "../core/clock.h"
+#include <algorithm>
+#include <cmath>
+
+void PalmScheduler::reset() {
+    interval_ = 1;
+    empty_runs_ = 0;
+    have_next_ = false;
+}
+
+void PalmScheduler::tracked(int hands) {
+    if (hands < tracked_) reset();
+    tracked_ = hands;
+}
+
+bool PalmScheduler::due(const Frame &frame) {
+    // Frame period from the capture timestamps, robust to dropped frames.
+    if (last_ts_ && frame.sequence > last_seq_ && frame.timestamp_ns > last_ts_) {
+        double period = (frame.timestamp_ns - last_ts_) / 1e6 / (double)(frame.sequence - last_seq_);
+        frame_ms_ += 0.1 * (period - frame_ms_);
+    }
+    last_seq_ = frame.sequence;
+    last_ts_ = frame.timestamp_ns;
+    rollWindow(monotonicNowNs());
+    return !have_next_ || frame.sequence >= next_seq_;
+}
+
+void PalmScheduler::report(const Frame &frame, bool found, double run_ms) {
+    run_ms_ = run_ms_ > 0.0 ? run_ms_ + 0.2 * (run_ms - run_ms_) : run_ms;
+    window_busy_ms_ += run_ms;
+
+    if (found) {
+        interval_ = 1;
+        empty_runs_ = 0;
+    } else {
+        if (++empty_runs_ >= PALM_BACKOFF_AFTER) {
+            interval_ *= 2;
+            empty_runs_ = 0;
+        }
+        const int latency_cap = std::max(1, (int)(max_latency_ms_ / frame_ms_));
+        const int budget_floor = budget_ > 0.0f ? (int)std::ceil(run_ms_ / (budget_ * frame_ms_)) : 1;
+        interval_ = std::max(budget_floor, std::min(interval_, latency_cap));
+    }
+    next_seq_ = frame.sequence + interval_;
+    have_next_ = true;
+}
+
+void PalmScheduler::idle() { rollWindow(monotonicNowNs()); }
+
+void PalmScheduler::rollWindow(uint64_t now_ns) {
+    if (!window_start_ns_) window_start_ns_ = now_ns;
+    double elapsed_ms = (now_ns - window_start_ns_) / 1e6;
+    if (elapsed_ms < 1000.0) return;
+    duty_ = (float)std::min(1.0, window_busy_ms_ / elapsed_ms);
+    window_start_ns_ = now_ns;
+    window_busy_ms_ = 0.0;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef PALM_SCHEDULER_H
+#define PALM_SCHEDULER_H
+
+#include "../core/types.h"
+
+// Decides which frames the palm detector runs on while hands are searched
+// for. Every frame after a detection; each PALM_BACKOFF_AFTER empty runs
+// double the frame interval, up to the acquisition latency budget
+// (max_latency_ms). While nothing is found the interval is also kept long
+// enough that detection stays within cpu_budget, the fraction of wall time
+// the palm stage may be busy.
+class PalmScheduler {
+public:
+    PalmScheduler(float cpu_budget, int max_latency_ms)
+        : budget_(cpu_budget), max_latency_ms_(max_latency_ms) {}
+
+    // Back to every frame, e.g. after a tracked hand was lost.
+    void reset();
+    // Current tracked hand count; resets when it drops. With one hand tracked
+    // every run re-finds that hand and backs off, so a loss must undo it.
+    void tracked(int hands);
+    bool due(const Frame &frame);
+    // found: the run saw a hand that is not tracked yet.
+    void report(const Frame &frame, bool found, double run_ms);
+    // Keeps the duty cycle current while the palm stage is not wanted.
+    void idle();
+
+    int interval() const { return interval_; }
+    // Fraction of wall time spent in palm detection over the last second.
+    float dutyCycle() const { return duty_; }
+
+private:
+    void rollWindow(uint64_t now_ns);
+
+    float budget_;
+    int max_latency_ms_;
+    int interval_ = 1;
+    int empty_runs_ = 0;
+    bool have_next_ = false;
+    uint64_t next_seq_ = 0;
+    int tracked_ = 0;
+
+    uint64_t last_seq_ = 0, last_ts_ = 0;
+    double frame_ms_ = 1000.0 / 30.0;
+    double run_ms_ = 0.0;
+
+    uint64_t window_start_ns_ = 0;
+    double window_busy_ms_ = 0.0;
+    float duty_ = 0.0f;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "palm_worker.h"
+#include <chrono>
+#include "../core/trace.h"
+
+void PalmWorker::run(PALM &palm_detector, Mailbox<FramePtr> &inputQueue, Mailbox<palm_candidates_t> &outputQueue,
+                     std::atomic<bool> &palmWanted, const std::atomic<int> &trackedHands, std::atomic<bool> &running)
+{
+    PalmScheduler scheduler(cpuBudget, maxLatencyMs);
+    traceThreadName("palm");
+    FramePtr frame;
+    while (running.load()) {
+        {
+            TRACE_SPAN("palm.wait");
+            if (!inputQueue.pop(frame)) break;
+        }
+        if (!frame || frame->image.empty()) continue;
+        // A hand was just lost; it is likely still close by.
+        scheduler.tracked(trackedHands.load());
+        if (!palmWanted.load()) {
+            frame.reset();
+            scheduler.idle();
+            continue;
+        }
+        if (!scheduler.due(*frame)) { frame.reset(); continue; }
+
+        palm_candidates_t out;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        palm_detector.run(*frame, out.result);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        out.palm_time_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        out.frame_sequence = frame->sequence;
+        // Detections beyond the tracked hands mean someone new is in view.
+        scheduler.report(*frame, out.result.num > trackedHands.load(), out.palm_time_ms);
+        out.palm_duty = scheduler.dutyCycle();
+        out.palm_interval = scheduler.interval();
+        frame.reset();
+
+        outputQueue.push(out);
+    }
+    outputQueue.stop();
+}
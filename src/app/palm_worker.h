@@ -0,0 +1,22 @@
+#ifndef PALM_WORKER_H
+#define PALM_WORKER_H
+
+#include "../core/types.h"
+#include "../core/frame_buffer.h"
+#include "../models/palm.h"
+#include "palm_scheduler.h"
+#include <atomic>
+
+// Palm detection on its own thread: while the tracker asks for re-acquisition
+// it runs on the newest frame that PalmScheduler lets through and publishes
+// candidates without blocking tracking.
+class PalmWorker {
+public:
+    void run(PALM &palm_detector, Mailbox<FramePtr> &inputQueue, Mailbox<palm_candidates_t> &outputQueue,
+             std::atomic<bool> &palmWanted, const std::atomic<int> &trackedHands, std::atomic<bool> &running);
+
+    float cpuBudget = PALM_CPU_BUDGET;
+    int maxLatencyMs = PALM_MAX_LATENCY_MS;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include "pipeline.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "../core/frame_buffer.h"
+#include "../core/landmark_log.h"
+#include "../core/trace.h"
+#include "../core/thread_placement.h"
+#include "../camera/camera.h"
+#include "../camera/file_source.h"
+#include "../models/palm.h"
+#include "../models/hand_landmark.h"
+#include "../mouse/mouse_control.h"
+#include "capture_worker.h"
+#include "inference_worker.h"
+#include "palm_worker.h"
+#include "cursor_worker.h"
+#if ENABLE_PREVIEW
+#include "renderer.h"
+#endif
+#include "headless_sink.h"
+
+bool Pipeline::run(const AppOptions &opt) {
+    stats_ = pipeline_stats_t();
+    const ThreadPlacement camera_place = {opt.cpus_camera, opt.rt_priority};
+    const ThreadPlacement capture_place = {opt.cpus_capture, opt.rt_priority};
+    const ThreadPlacement cursor_place = {opt.cpus_cursor, opt.rt_priority};
+    const ThreadPlacement palm_place = {opt.cpus_palm, 0};
+    const ThreadPlacement inference_place = {opt.cpus_inference, 0};
+    const ThreadPlacement render_place = {opt.cpus_render, 0};
+    const bool is_camera = opt.source == "camera";
+
+    std::unique_ptr<FrameSource> source;
+    if (is_camera) {
+        std::unique_ptr<SimpleCamera> cam(new SimpleCamera);
+        // libcamera starts its threads here and in start(); they inherit this.
+        ScopedPlacement place(camera_place, "camera");
+        if (!cam->initCamera()) return false;
+        cam->pixelFormat = opt.pixel_format;
+        cam->configureStill(opt.width, opt.height);
+        cam->frameRate = opt.camera_fps;
+        source = std::move(cam);
+    } else {
+        std::unique_ptr<FileFrameSource> file(new FileFrameSource(opt.source, opt.replay_realtime, opt.replay_loop));
+        file->fps = opt.source_fps;
+        if (!file->open()) return false;
+        source = std::move(file);
+    }
+
+    PALM palmDetector;
+    HandLandmark handDetector;
+    palmDetector.backend = opt.palm_backend;
+    palmDetector.fp16 = opt.palm_fp16;
+    palmDetector.nthreads = opt.palm_threads;
+    palmDetector.weightedNms = opt.palm_weighted_nms;
+    handDetector.backend = opt.hand_backend;
+    handDetector.fp16 = opt.hand_fp16;
+    handDetector.nthreads = opt.hand_threads;
+    handDetector.motionThreshold = opt.hand_motion_thresh;
+    handDetector.maxReuse = opt.hand_max_reuse;
+    // Interpreter pools are created by loadModel() or by the first Invoke()
+    // on the stage thread; either way they end up on the stage's CPUs.
+    try {
+        {
+            ScopedPlacement place(palm_place, "palm interpreter");
+            palmDetector.loadModel(opt.palm_model);
+        }
+        {
+            ScopedPlacement place(inference_place, "hand interpreter");
+            handDetector.loadModel(opt.hand_model);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Model Error: " << e.what() << std::endl;
+        return false;
+    }
+    if (!quiet)
+        std::cout << "Palm model: " << opt.palm_model << " [" << palmDetector.backendInfo() << "]\n"
+                  << "Hand model: " << opt.hand_model << " [" << handDetector.backendInfo() << "]\n";
+
+    // Without init() the controller is a no-op sink.
+    MouseController mouse;
+    if (opt.mouse && !mouse.init()) {
+        std::cerr << "WARNING: Mouse init failed. Run with sudo?\n";
+    }
+
+    if (!opt.cpus_palm.empty() && opt.palm_threads > (int)opt.cpus_palm.size())
+        std::cerr << "WARNING: " << opt.palm_threads << " palm threads on " << opt.cpus_palm.size() << " CPUs\n";
+    if (!opt.cpus_inference.empty() && opt.hand_threads > (int)opt.cpus_inference.size())
+        std::cerr << "WARNING: " << opt.hand_threads << " hand threads on " << opt.cpus_inference.size() << " CPUs\n";
+
+    {
+        ScopedPlacement place(is_camera ? camera_place : ThreadPlacement(), "camera");
+        if (!source->start()) return false;
+    }
+    if (!opt.trace_path.empty()) traceStart(opt.trace_path);
+    uint32_t width = source->width();
+    uint32_t height = source->height();
+    LandmarkLogWriter log;
+    if (!opt.record_path.empty() && !log.open(opt.record_path, width, height)) {
+        source->stop();
+        traceStop();
+        return false;
+    }
+
+    Mailbox<FramePtr> capBuf;
+    Mailbox<FramePtr> palmInBuf;
+    Mailbox<palm_candidates_t> palmOutBuf;
+    Mailbox<detection_output_t> outBuf;
+    Mailbox<cursor_target_t> cursorBuf;
+    std::atomic<bool> palmWanted{true};
+    std::atomic<int> trackedHands{0};
+    std::atomic<bool> running{true};
+
+    CaptureWorker capWorker;
+    PalmWorker palmWorker;
+    palmWorker.cpuBudget = opt.palm_budget;
+    palmWorker.maxLatencyMs = opt.palm_latency_ms;
+    InferenceWorker inferWorker;
+    inferWorker.cursorFilter = opt.cursor_filter;
+    CursorWorker cursorWorker;
+    cursorWorker.rateHz = opt.cursor_hz;
+    cursorWorker.predict = opt.cursor_predict;
+    inferWorker.attachFrames = !opt.headless;
+    if (log.isOpen()) inferWorker.log = &log;
+    HeadlessSink headlessSink;
+    headlessSink.warmupSec = warmupSeconds;
+    headlessSink.measureLatency = source->paced();
+    headlessSink.quiet = quiet;
+#if ENABLE_PREVIEW
+    Renderer renderer;
+    renderer.previewFps = opt.preview_fps;
+#endif
+
+    std::thread t1(&CaptureWorker::run, &capWorker, std::ref(*source), std::ref(capBuf), std::ref(palmInBuf),
+                   std::ref(palmWanted), std::ref(running));
+
+    std::thread t2(&InferenceWorker::run, &inferWorker, 
+                   std::ref(handDetector), std::ref(cursorBuf),
+                   std::ref(capBuf), std::ref(palmOutBuf), std::ref(outBuf), 
+                   std::ref(palmWanted), std::ref(trackedHands), std::ref(running), width, height);
+    
+#if ENABLE_PREVIEW
+    std::thread t3 = opt.headless
+        ? std::thread(&HeadlessSink::run, &headlessSink, std::ref(outBuf), std::ref(running))
+        : std::thread(&Renderer::run, &renderer, std::ref(outBuf), std::ref(running), width, height);
+#else
+    std::thread t3(&HeadlessSink::run, &headlessSink, std::ref(outBuf), std::ref(running));
+#endif
+
+    std::thread t4(&PalmWorker::run, &palmWorker, std::ref(palmDetector), std::ref(palmInBuf), std::ref(palmOutBuf),
+                   std::ref(palmWanted), std::cref(trackedHands), std::ref(running));
+
+    std::thread t5(&CursorWorker::run, &cursorWorker, std::ref(mouse), std::ref(cursorBuf), std::ref(running));
+
+    applyPlacement(t1.native_handle(), capture_place, "capture");
+    applyPlacement(t2.native_handle(), inference_place, "inference");
+    applyPlacement(t3.native_handle(), render_place, "render");
+    applyPlacement(t4.native_handle(), palm_place, "palm");
+    applyPlacement(t5.native_handle(), cursor_place, "cursor");
+
+    // A time limit stops the run the same way closing the preview does.
+    std::atomic<bool> joined{false};
+    std::thread timer;
+    if (runSeconds > 0.0) {
+        timer = std::thread([&] {
+            auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                              std::chrono::duration<double>(runSeconds));
+            while (!joined.load() && std::chrono::steady_clock::now() < end)
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            running.store(false);
+        });
+    }
+
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+    t5.join();
+    joined.store(true);
+    if (timer.joinable()) timer.join();
+    stats_ = headlessSink.stats();
+
+    source->stop();
+    traceStop();
+    capBuf.stop();
+    palmInBuf.stop();
+    palmOutBuf.stop();
+    outBuf.stop();
+    cursorBuf.stop();
+    const uint64_t logged = log.count();
+    const bool log_ok = log.close();
+
+    if (quiet) return true;
+    std::cout << "Source: " << source->droppedFrames() << " frames dropped\n"
+              << "Capture->Inference: " << capBuf.published() << " published, " << capBuf.consumed() << " consumed, "
+              << capBuf.overwritten() << " overwritten\n"
+              << "Inference->Render: " << outBuf.published() << " published, " << outBuf.consumed() << " consumed, "
+              << outBuf.overwritten() << " overwritten\n";
+    if (stats_.latency_p50_ms > 0.0)
+        std::cout << "Capture->Result latency: p50 " << stats_.latency_p50_ms << "ms, p95 " << stats_.latency_p95_ms << "ms\n";
+    std::cout << "Frame pool: " << source->poolMisses() << " misses\n";
+#if ALLOC_STATS
+    if (stats_.frames) std::cout << "Heap: " << stats_.allocs_per_frame << " allocations/frame\n";
+#endif
+    if (mouse.writeErrors() || mouse.shortWrites())
+        std::cout << "Mouse: " << mouse.writeErrors() << " failed writes, " << mouse.shortWrites() << " short writes\n";
+    if (!opt.record_path.empty() && log_ok)
+        std::cout << "Log: " << logged << " frames written to " << opt.record_path << "\n";
+
+    return true;
+}
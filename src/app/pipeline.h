@@ -0,0 +1,25 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "../core/app_options.h"
+#include "../core/types.h"
+
+// The whole application for one set of options: opens the source, loads the
+// models, runs every stage on its own thread and tears it all down again.
+class Pipeline {
+public:
+    // Runs until the source ends, the preview is closed or runSeconds pass.
+    // false if the source or a model could not be set up.
+    bool run(const AppOptions &opt);
+    // Results sink figures of the last headless run.
+    const pipeline_stats_t &stats() const { return stats_; }
+
+    double runSeconds = 0.0;     // 0: no limit
+    double warmupSeconds = 0.0;  // left out of stats()
+    bool quiet = false;          // no per-second or exit reports
+
+private:
+    pipeline_stats_t stats_;
+};
+
+#endif
@@ -1,11 +1,20 @@
 #include "renderer.h"
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include "../core/trace.h"
+#include "../models/preprocess.h"
 
-void Renderer::run(SafeQueue<detection_output_t> &outputQueue, std::atomic<bool> &running, uint32_t width, uint32_t height) {
+static const int kConnections[][2] = {
+    {0,1}, {1,2}, {2,3}, {3,4}, {0,5}, {5,6}, {6,7}, {7,8},
+    {5,9}, {9,10}, {10,11}, {11,12}, {9,13}, {13,14}, {14,15}, {15,16},
+    {13,17}, {0,17}, {17,18}, {18,19}, {19,20}
+};
+
+void Renderer::run(Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &running, uint32_t width, uint32_t height) {
     cv::namedWindow("Hand Tracking Final", cv::WINDOW_FULLSCREEN);
     int reg_x = (width - MOUSE_REGION_W) / 2;
     int reg_y = (height - MOUSE_REGION_H) / 2;
@@ -13,15 +22,29 @@ void Renderer::run(SafeQueue<detection_output_t> &outputQueue, std::atomic<bool>
 
     double fps = 0.0;
     int frame_counter = 0;
-    auto last_fps_time = std::chrono::high_resolution_clock::now();
+    auto last_fps_time = std::chrono::steady_clock::now();
+    const auto period = std::chrono::microseconds(previewFps > 0 ? 1000000 / previewFps : 0);
+    auto next_show = last_fps_time;
 
     detection_output_t out;
+    cv::Mat canvas;
+    char text[96];
+    traceThreadName("render");
     while (running.load()) {
-        if (!outputQueue.pop(out)) break;
-        if (out.frame.empty()) continue;
+        if (period.count()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now < next_show) std::this_thread::sleep_until(next_show);
+            next_show = std::max(next_show + period, now);
+        }
+        {
+            TRACE_SPAN("render.wait");
+            if (!outputQueue.pop(out)) break;
+        }
+        if (!out.frame || out.frame->image.empty()) continue;
+        TRACE_SPAN("render.frame");
 
         frame_counter++;
-        auto current_time = std::chrono::high_resolution_clock::now();
+        auto current_time = std::chrono::steady_clock::now();
         double elapsed_sec = std::chrono::duration<double>(current_time - last_fps_time).count();
         if (elapsed_sec >= 1.0) { 
             fps = frame_counter / elapsed_sec;
@@ -29,37 +52,47 @@ void Renderer::run(SafeQueue<detection_output_t> &outputQueue, std::atomic<bool>
             last_fps_time = current_time;
         }
 
-        cv::rectangle(out.frame, mouse_rect, cv::Scalar(0, 255, 255), 2);
+        // The camera buffer is read-only; flip (if needed) and copy in one pass.
+        const image_view_t &view = out.frame->view;
+        if (view.format == IMAGE_BGR888) {
+            if (out.frame->mirrored) cv::flip(out.frame->image, canvas, 1);
+            else out.frame->image.copyTo(canvas);
+        } else {
+            canvas.create(view.height, view.width, CV_8UC3);
+            convert_to_bgr(view, canvas.data, canvas.step);
+            if (out.frame->mirrored) cv::flip(canvas, canvas, 1);
+        }
+        out.frame.reset();
+
+        cv::rectangle(canvas, mouse_rect, cv::Scalar(0, 255, 255), 2);
         
-        for (const auto &h : out.hand_results) {
-             const std::vector<std::pair<int, int>> connections = {
-                {0,1}, {1,2}, {2,3}, {3,4}, {0,5}, {5,6}, {6,7}, {7,8},
-                {5,9}, {9,10}, {10,11}, {11,12}, {9,13}, {13,14}, {14,15}, {15,16},
-                {13,17}, {0,17}, {17,18}, {18,19}, {19,20}
-            };
-            for (auto& c : connections) {
-                cv::line(out.frame, cv::Point(h.joint[c.first].x, h.joint[c.first].y),
-                         cv::Point(h.joint[c.second].x, h.joint[c.second].y), cv::Scalar(255, 255, 0), 2, cv::LINE_AA);
+        for (int k = 0; k < out.hand_count; ++k) {
+            const hand_landmark_result_t &h = out.hand_results[k];
+            for (const auto &c : kConnections) {
+                cv::line(canvas, cv::Point(h.joint[c[0]].x, h.joint[c[0]].y),
+                         cv::Point(h.joint[c[1]].x, h.joint[c[1]].y), cv::Scalar(255, 255, 0), 2, cv::LINE_AA);
             }
-            cv::circle(out.frame, cv::Point(h.joint[9].x, h.joint[9].y), 6, cv::Scalar(0,0,255), -1);
+            cv::circle(canvas, cv::Point(h.joint[9].x, h.joint[9].y), 6, cv::Scalar(0,0,255), -1);
             for (int i = 0; i < HAND_JOINT_NUM; i++) {
-                if(i != 9) cv::circle(out.frame, cv::Point(h.joint[i].x, h.joint[i].y), 4, (i==0?cv::Scalar(0,0,255):cv::Scalar(0,255,0)), -1, cv::LINE_AA);
+                if(i != 9) cv::circle(canvas, cv::Point(h.joint[i].x, h.joint[i].y), 4, (i==0?cv::Scalar(0,0,255):cv::Scalar(0,255,0)), -1, cv::LINE_AA);
             }
         }
 
-        cv::putText(out.frame, out.is_tracking ? "Tracking" : "Searching", cv::Point(10, 20), 
+        cv::putText(canvas, out.is_tracking ? "Tracking" : "Searching", cv::Point(10, 20), 
                     cv::FONT_HERSHEY_SIMPLEX, 0.5, out.is_tracking ? cv::Scalar(0,255,0) : cv::Scalar(0,0,255), 2);
         
-        std::stringstream ss_palm; ss_palm << "Palm: " << std::fixed << std::setprecision(1) << out.palm_time_ms << "ms";
-        cv::putText(out.frame, ss_palm.str(), cv::Point(10, 40), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 2);
+        snprintf(text, sizeof(text), "Palm: %.1fms (duty %.0f%%)", out.palm_time_ms, out.palm_duty * 100.0f);
+        cv::putText(canvas, text, cv::Point(10, 40), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 2);
 
-        std::stringstream ss_hand; ss_hand << "Hand: " << std::fixed << std::setprecision(1) << out.hand_time_ms << "ms";
-        cv::putText(out.frame, ss_hand.str(), cv::Point(10, 60), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 2);
+        int n = snprintf(text, sizeof(text), "Hand: %.1fms", out.hand_time_ms);
+        if (out.hand_reused) snprintf(text + n, sizeof(text) - n, " (reused %d/%d)", out.hand_reused, out.hand_rois);
+        cv::putText(canvas, text, cv::Point(10, 60), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 2);
 
-        std::stringstream ss_fps; ss_fps << "FPS: " << std::fixed << std::setprecision(1) << fps;
-        cv::putText(out.frame, ss_fps.str(), cv::Point(out.frame.cols - 130, 20), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
+        snprintf(text, sizeof(text), "FPS: %.1f", fps);
+        cv::putText(canvas, text, cv::Point(canvas.cols - 130, 20), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
 
-        cv::imshow("Hand Tracking Final", out.frame);
+        TRACE_SPAN("render.show");
+        cv::imshow("Hand Tracking Final", canvas);
         if (cv::waitKey(1) == 27) running.store(false);
     }
-}
\ No newline at end of file
+}
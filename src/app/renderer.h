@@ -5,9 +5,14 @@
 #include "../core/frame_buffer.h"
 #include <atomic>
 
+// Preview window. Wakes at most previewFps times a second, takes the newest
+// result and draws only that one; everything in between is skipped in the
+// mailbox without being touched.
 class Renderer {
 public:
-    void run(SafeQueue<detection_output_t> &outputQueue, std::atomic<bool> &running, uint32_t width, uint32_t height);
+    void run(Mailbox<detection_output_t> &outputQueue, std::atomic<bool> &running, uint32_t width, uint32_t height);
+
+    int previewFps = PREVIEW_FPS;   // 0: every result
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,119 @@
+#include "tuner.h"
+#include "pipeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+std::string Tuner::describe(const AppOptions &opt) {
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "%s/%s palm x%d hand x%d", backendName(opt.palm_backend),
+                     backendName(opt.hand_backend), opt.palm_threads, opt.hand_threads);
+    if (opt.source == "camera")
+        snprintf(buf + n, sizeof(buf) - n, " %dx%d@%d", opt.width, opt.height, opt.camera_fps);
+    return buf;
+}
+
+bool Tuner::better(const pipeline_stats_t &a, const pipeline_stats_t &b) {
+    if (a.fps > b.fps * 1.05) return true;
+    if (b.fps > a.fps * 1.05) return false;
+    if (a.latency_p95_ms > 0.0 && b.latency_p95_ms > 0.0) return a.latency_p95_ms < b.latency_p95_ms;
+    return a.fps > b.fps;
+}
+
+bool Tuner::measure(const AppOptions &opt, pipeline_stats_t &stats) {
+    Pipeline pipeline;
+    pipeline.runSeconds = trialSeconds;
+    pipeline.warmupSeconds = 1.0;
+    pipeline.quiet = true;
+    bool ok = pipeline.run(opt) && pipeline.stats().frames > 0;
+    stats = pipeline.stats();
+    if (ok) {
+        printf("[tune] %-40s %6.1f fps", describe(opt).c_str(), stats.fps);
+        if (stats.latency_p50_ms > 0.0) printf(", latency p50 %.1fms p95 %.1fms", stats.latency_p50_ms, stats.latency_p95_ms);
+        printf(", hand %.1fms\n", stats.hand_ms);
+    } else {
+        printf("[tune] %-40s failed\n", describe(opt).c_str());
+    }
+    fflush(stdout);
+    return ok;
+}
+
+void Tuner::sweep(const char *what, const std::vector<AppOptions> &candidates) {
+    printf("[tune] %s\n", what);
+    for (const AppOptions &c : candidates) {
+        if (describe(c) == describe(best_)) continue;
+        pipeline_stats_t stats;
+        if (measure(c, stats) && better(stats, best_stats_)) {
+            best_ = c;
+            best_stats_ = stats;
+        }
+    }
+}
+
+bool Tuner::run(const AppOptions &base, const std::string &path) {
+    AppOptions opt = base;
+    opt.mouse = false;
+    opt.headless = true;
+    opt.trace_path.clear();
+    opt.record_path.clear();
+    if (opt.source != "camera") opt.replay_loop = true;
+    if (opt.source != "camera" && !opt.replay_realtime)
+        std::cerr << "[tune] --pace=fast: throughput only, latency is not measured\n";
+
+    printf("[tune] %d s per run on %s\n", trialSeconds, opt.source.c_str());
+    best_ = opt;
+    if (!measure(best_, best_stats_)) {
+        std::cerr << "[tune] the starting configuration does not run\n";
+        return false;
+    }
+
+    std::vector<AppOptions> c;
+    for (InferenceBackend b : {InferenceBackend::DEFAULT, InferenceBackend::XNNPACK, InferenceBackend::CPU}) {
+        AppOptions o = best_;
+        o.palm_backend = o.hand_backend = b;
+        c.push_back(o);
+    }
+    sweep("backend", c);
+
+    // Capture, cursor output and the preview need little CPU; leave the rest
+    // to the two interpreters.
+    int cores = std::max(2, (int)std::thread::hardware_concurrency());
+    c.clear();
+    for (int p = 1; p <= std::min(2, cores - 1); ++p) {
+        for (int h = 1; h <= std::min(4, cores - p); ++h) {
+            AppOptions o = best_;
+            o.palm_threads = p;
+            o.hand_threads = h;
+            c.push_back(o);
+        }
+    }
+    sweep("threads", c);
+
+    if (opt.source == "camera") {
+        c.clear();
+        for (auto wh : {std::make_pair(640, 480), std::make_pair(800, 600)}) {
+            AppOptions o = best_;
+            o.width = wh.first;
+            o.height = wh.second;
+            c.push_back(o);
+        }
+        sweep("resolution", c);
+
+        c.clear();
+        for (int fps : {30, 60}) {
+            AppOptions o = best_;
+            o.camera_fps = fps;
+            c.push_back(o);
+        }
+        sweep("camera rate", c);
+    }
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "%s: %.1f fps, p95 latency %.1fms on %s", describe(best_).c_str(),
+             best_stats_.fps, best_stats_.latency_p95_ms, opt.source.c_str());
+    printf("[tune] best %s\n", summary);
+    if (!saveTunedOptions(best_, path, summary)) return false;
+    printf("[tune] written to %s\n", path.c_str());
+    return true;
+}
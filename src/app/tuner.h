@@ -0,0 +1,31 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "../core/app_options.h"
+#include "../core/types.h"
+#include <string>
+#include <vector>
+
+// --tune: runs the pipeline headless on the configured source for a few
+// seconds per setting and keeps what performs best. One setting is swept at
+// a time with the others at their best so far: backend, palm/hand thread
+// split, then resolution and frame rate (live camera only). Best means the
+// highest throughput, and among results within 5% of each other the lowest
+// p95 capture-to-result latency (realtime sources only).
+class Tuner {
+public:
+    bool run(const AppOptions &base, const std::string &path);
+
+    int trialSeconds = 6;   // the first second is warm-up
+
+private:
+    void sweep(const char *what, const std::vector<AppOptions> &candidates);
+    bool measure(const AppOptions &opt, pipeline_stats_t &stats);
+    static bool better(const pipeline_stats_t &a, const pipeline_stats_t &b);
+    static std::string describe(const AppOptions &opt);
+
+    AppOptions best_;
+    pipeline_stats_t best_stats_;
+};
+
+#endif
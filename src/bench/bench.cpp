@@ -0,0 +1,133 @@
+#include "bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_ns(bench_clock::time_point t0, bench_clock::time_point t1) {
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+static double percentile(const std::vector<double> &sorted, double q) {
+    size_t i = (size_t)(q * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+void BenchSuite::add(const std::string &name, std::function<void()> fn) {
+    _cases.push_back({name, std::move(fn)});
+}
+
+void BenchSuite::run(const std::string &filter, double min_time_s, std::vector<BenchResult> &results) const {
+    const double batch_target_ns = 50e3;
+    const size_t min_batches = 30;
+
+    for (const auto &c : _cases) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+
+        // Warm up (first-touch allocations, caches) and size the batch.
+        c.fn();
+        uint64_t batch = 1;
+        for (;;) {
+            auto t0 = bench_clock::now();
+            for (uint64_t i = 0; i < batch; ++i) c.fn();
+            double ns = elapsed_ns(t0, bench_clock::now());
+            if (ns >= batch_target_ns || batch >= (1u << 20)) break;
+            batch *= ns > 0 ? std::min<uint64_t>(16, std::max<uint64_t>(2, (uint64_t)(batch_target_ns / ns) + 1)) : 16;
+        }
+
+        std::vector<double> per_op;
+        uint64_t iters = 0;
+        uint64_t allocs = 0, bytes = 0;
+        double total_ns = 0;
+        auto start = bench_clock::now();
+        while (per_op.size() < min_batches || elapsed_ns(start, bench_clock::now()) < min_time_s * 1e9) {
+            uint64_t allocs0 = heapAllocCount(), bytes0 = heapAllocBytes();
+            auto t0 = bench_clock::now();
+            for (uint64_t i = 0; i < batch; ++i) c.fn();
+            double ns = elapsed_ns(t0, bench_clock::now());
+            allocs += heapAllocCount() - allocs0;
+            bytes += heapAllocBytes() - bytes0;
+            per_op.push_back(ns / batch);
+            total_ns += ns;
+            iters += batch;
+        }
+
+        std::sort(per_op.begin(), per_op.end());
+        BenchResult r;
+        r.name = c.name;
+        r.iters = iters;
+        r.ns_mean = total_ns / iters;
+        r.ns_min = per_op.front();
+        r.ns_p50 = percentile(per_op, 0.50);
+        r.ns_p90 = percentile(per_op, 0.90);
+        r.ns_p99 = percentile(per_op, 0.99);
+        r.allocs_per_op = (double)allocs / iters;
+        r.bytes_per_op = (double)bytes / iters;
+        results.push_back(r);
+    }
+}
+
+static const BenchResult *findResult(const std::vector<BenchResult> &v, const std::string &name) {
+    for (const auto &r : v) if (r.name == name) return &r;
+    return nullptr;
+}
+
+void printResults(const std::vector<BenchResult> &results, BenchFormat format,
+                  const std::vector<BenchResult> &baseline) {
+    if (format == BENCH_CSV) {
+        printf("name,iters,ns_mean,ns_p50,ns_p90,ns_p99,ns_min,allocs_per_op,bytes_per_op\n");
+        for (const auto &r : results)
+            printf("%s,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.1f\n", r.name.c_str(), (unsigned long long)r.iters,
+                   r.ns_mean, r.ns_p50, r.ns_p90, r.ns_p99, r.ns_min, r.allocs_per_op, r.bytes_per_op);
+        return;
+    }
+    if (format == BENCH_JSON) {
+        printf("[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult &r = results[i];
+            const BenchResult *b = findResult(baseline, r.name);
+            printf("  {\"name\": \"%s\", \"iters\": %llu, \"ns_mean\": %.1f, \"ns_p50\": %.1f, \"ns_p90\": %.1f, "
+                   "\"ns_p99\": %.1f, \"ns_min\": %.1f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f",
+                   r.name.c_str(), (unsigned long long)r.iters, r.ns_mean, r.ns_p50, r.ns_p90, r.ns_p99,
+                   r.ns_min, r.allocs_per_op, r.bytes_per_op);
+            if (b) printf(", \"baseline_ns_p50\": %.1f", b->ns_p50);
+            printf("}%s\n", i + 1 < results.size() ? "," : "");
+        }
+        printf("]\n");
+        return;
+    }
+    printf("%-36s %12s %12s %12s %12s %10s %10s%s\n", "benchmark", "ns/op", "p50", "p90", "p99",
+           "allocs/op", "bytes/op", baseline.empty() ? "" : "   vs base");
+    for (const auto &r : results) {
+        printf("%-36s %12.1f %12.1f %12.1f %12.1f %10.2f %10.0f", r.name.c_str(), r.ns_mean, r.ns_p50,
+               r.ns_p90, r.ns_p99, r.allocs_per_op, r.bytes_per_op);
+        const BenchResult *b = findResult(baseline, r.name);
+        if (b && b->ns_p50 > 0) printf("   %+7.1f%%", 100.0 * (r.ns_p50 - b->ns_p50) / b->ns_p50);
+        printf("\n");
+    }
+}
+
+bool loadBaseline(const std::string &path, std::vector<BenchResult> &baseline) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    std::getline(in, line); // header
+    while (std::getline(in, line)) {
+        std::stringstream ss(line);
+        std::string field;
+        std::vector<std::string> f;
+        while (std::getline(ss, field, ',')) f.push_back(field);
+        if (f.size() < 9) continue;
+        BenchResult r;
+        r.name = f[0];
+        r.iters = std::stoull(f[1]);
+        r.ns_mean = std::stod(f[2]); r.ns_p50 = std::stod(f[3]); r.ns_p90 = std::stod(f[4]);
+        r.ns_p99 = std::stod(f[5]); r.ns_min = std::stod(f[6]);
+        r.allocs_per_op = std::stod(f[7]); r.bytes_per_op = std::stod(f[8]);
+        baseline.push_back(r);
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "../core/alloc_count.h"
+
+struct BenchResult {
+    std::string name;
+    uint64_t iters = 0;
+    double ns_mean = 0, ns_p50 = 0, ns_p90 = 0, ns_p99 = 0, ns_min = 0;
+    double allocs_per_op = 0, bytes_per_op = 0;
+};
+
+// Each case is run in batches sized to ~50us, until a time budget is spent;
+// percentiles are taken over the per-batch ns/op.
+class BenchSuite {
+public:
+    void add(const std::string &name, std::function<void()> fn);
+    void run(const std::string &filter, double min_time_s, std::vector<BenchResult> &results) const;
+
+private:
+    struct Case { std::string name; std::function<void()> fn; };
+    std::vector<Case> _cases;
+};
+
+enum BenchFormat { BENCH_TABLE, BENCH_CSV, BENCH_JSON };
+
+// baseline: results of an earlier --format=csv run (may be empty).
+void printResults(const std::vector<BenchResult> &results, BenchFormat format,
+                  const std::vector<BenchResult> &baseline);
+bool loadBaseline(const std::string &path, std::vector<BenchResult> &baseline);
+
+namespace cv { class Mat; }
+
+// Case groups; frame is a synthetic packed BGR888 camera frame.
+// YUV sampling kernels against convert_to_bgr + the BGR kernels; prints the
+// differences and returns false on a mismatch.
+bool checkYuvKernels(const cv::Mat &frame);
+// Palm scheduling backs off while a hand is tracked and searches the next
+// frame once it is lost; returns false otherwise.
+bool checkPalmReacquire();
+// Palm decode + NMS + packing make no heap allocations in steady state.
+bool checkPalmPostprocessNoAlloc();
+void addPreprocessBenches(BenchSuite &suite, const cv::Mat &frame);
+void addKernelBenches(BenchSuite &suite, const cv::Mat &frame);
+void addModelBenches(BenchSuite &suite, const cv::Mat &frame,
+                     const std::string &palm_model, const std::string &hand_model);
+
+#endif
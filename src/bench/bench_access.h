@@ -0,0 +1,43 @@
+#ifndef BENCH_ACCESS_H
+#define BENCH_ACCESS_H
+
+#include "../models/palm.h"
+#include "../models/hand_landmark.h"
+#include "../app/inference_worker.h"
+#include <cstring>
+
+// Friend of the classes whose private hot paths are benchmarked.
+struct BenchAccess {
+    static void setPalmOutputs(PALM &palm, const float *bbox, const float *prob) {
+        palm._pPalmOutputLayerBbox = bbox;
+        palm._pPalmOutputLayerProb = prob;
+    }
+    static int decodeKeypoints(PALM &palm, float score_thresh) { return palm.decode_keypoints(score_thresh); }
+    static palm_t *candidates(PALM &palm) { return palm._candidates.data(); }
+    static int nonMaxSuppression(PALM &palm, palm_t *cands, int n, float iou_thresh, bool weighted) {
+        return palm.non_max_suppression(cands, n, iou_thresh, weighted);
+    }
+    static int postprocess(PALM &palm, palm_detection_result_t &result) { return palm.postprocess(result); }
+    static tflite::Interpreter &interpreter(PALM &palm) { return *palm._palm_interpreter; }
+    static tflite::Interpreter &interpreter(HandLandmark &hand) { return *hand._hand_interpreter; }
+
+    static cursor_target_t processMouseLogic(InferenceWorker &w, const hand_landmark_result_t &res,
+                                             uint32_t width, uint32_t height, uint64_t frame_ts_ns) {
+        return w.processMouseLogic(res, width, height, frame_ts_ns);
+    }
+
+    // Fills every input tensor with a fixed byte pattern.
+    static void fillInputs(tflite::Interpreter &interp) {
+        for (int idx : interp.inputs()) {
+            TfLiteTensor *t = interp.tensor(idx);
+            if (t->type == kTfLiteFloat32) {
+                float *p = t->data.f;
+                for (size_t i = 0; i < t->bytes / sizeof(float); ++i) p[i] = (float)(i % 251) / 255.0f;
+            } else {
+                for (size_t i = 0; i < t->bytes; ++i) t->data.raw[i] = (char)(i % 251);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,264 @@
+// Post-processing, geometry and tracking kernels on synthetic data.
+#include "bench.h"
+#include "bench_access.h"
+#include "../models/anchors.h"
+#include "../models/preprocess.h"
+#include "../tracking/roi_tracker.h"
+#include "../tracking/cursor_filter.h"
+#include "../mouse/mouse_control.h"
+#include "../app/palm_scheduler.h"
+#include "../core/frame_pool.h"
+#include "../core/landmark_log.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Palm model outputs with one hand: a cluster of anchors above threshold
+// around the frame center, everything else well below.
+struct PalmOutputs {
+    std::vector<float> bbox, prob;
+    PalmOutputs() : bbox(PalmAnchors::count * 18, 0.0f), prob(PalmAnchors::count, -8.0f) {
+        for (int i = 0; i < PalmAnchors::count; ++i) {
+            const Anchor a = PalmAnchors::table[i];
+            float dx = a.x_center - 0.5f, dy = a.y_center - 0.5f;
+            if (dx * dx + dy * dy > 0.01f) continue;
+            prob[i] = 3.0f - 100.0f * (dx * dx + dy * dy);
+            float *p = &bbox[i * 18];
+            p[0] = -dx * 192.0f; p[1] = -dy * 192.0f; p[2] = 60.0f; p[3] = 60.0f;
+            for (int j = 0; j < 7; ++j) {
+                p[4 + 2 * j] = p[0] + 20.0f * std::cos(j * 0.9f);
+                p[5 + 2 * j] = p[1] + 20.0f * std::sin(j * 0.9f);
+            }
+        }
+    }
+};
+
+// An open right hand, palm facing the camera, in frame pixels.
+static hand_landmark_result_t syntheticHand(float cx, float cy, float size, bool pinch) {
+    hand_landmark_result_t h = {};
+    h.hand_id = 0;
+    h.score = 0.95f;
+    h.joint[0] = {cx, cy + size * 0.5f, 0.0f};
+    for (int f = 0; f < 5; ++f) {
+        float angle = -2.4f + f * 0.35f;
+        for (int k = 0; k < 4; ++k) {
+            float r = size * (0.25f + 0.15f * k) * (f == 0 ? 0.8f : 1.0f);
+            h.joint[1 + 4 * f + k] = {h.joint[0].x + r * std::cos(angle), h.joint[0].y + r * std::sin(angle), 0.0f};
+        }
+    }
+    if (pinch) h.joint[8] = h.joint[12];
+    return h;
+}
+
+bool checkPalmReacquire() {
+    // One hand tracked for three seconds at 30 fps: every palm run re-finds
+    // it, so nothing new is found and the scheduler backs off. Then the hand
+    // is lost and the very next frame must be searched.
+    PalmScheduler scheduler(PALM_CPU_BUDGET, PALM_MAX_LATENCY_MS);
+    Frame f;
+    int runs = 0;
+    for (uint64_t seq = 0; seq < 90; ++seq) {
+        f.sequence = seq;
+        f.timestamp_ns = seq * 33333333;
+        scheduler.tracked(1);
+        if (scheduler.due(f)) {
+            scheduler.report(f, false, 8.0);
+            runs++;
+        }
+    }
+    const int backed_off = scheduler.interval();
+    f.sequence = 90;
+    f.timestamp_ns = 90 * 33333333ull;
+    scheduler.tracked(0);
+    const bool pass = backed_off > 1 && scheduler.due(f);
+    fprintf(stderr, "check palm re-acquire: %d runs in 90 frames, interval %d, due right after the loss: %s\n",
+            runs, backed_off, pass ? "ok" : "FAILED");
+    return pass;
+}
+
+bool checkPalmPostprocessNoAlloc() {
+    // Decode + NMS + packing must not touch the heap once warmed up, with
+    // either NMS variant.
+    PALM palm;
+    PalmOutputs outputs;
+    BenchAccess::setPalmOutputs(palm, outputs.bbox.data(), outputs.prob.data());
+    bool pass = true;
+    for (bool weighted : {false, true}) {
+        palm.weightedNms = weighted;
+        palm_detection_result_t result;
+        BenchAccess::postprocess(palm, result);
+        const uint64_t before = heapAllocCount();
+        for (int i = 0; i < 1000; ++i) BenchAccess::postprocess(palm, result);
+        const uint64_t allocs = heapAllocCount() - before;
+        const bool ok = allocs == 0 && result.num > 0;
+        fprintf(stderr, "check palm postprocess%s: %d palms, %llu allocations in 1000 runs %s\n",
+                weighted ? " (weighted)" : "", result.num, (unsigned long long)allocs, ok ? "ok" : "FAILED");
+        pass = pass && ok;
+    }
+    return pass;
+}
+
+void addKernelBenches(BenchSuite &suite, const cv::Mat &frame) {
+    const int W = frame.cols, H = frame.rows;
+
+    auto palm = std::make_shared<PALM>();
+    auto outputs = std::make_shared<PalmOutputs>();
+    BenchAccess::setPalmOutputs(*palm, outputs->bbox.data(), outputs->prob.data());
+    suite.add("palm/decode_keypoints", [=] { BenchAccess::decodeKeypoints(*palm, palm->confThreshold); });
+
+    // NMS reorders its input in place, so every op starts from a fresh copy.
+    int n = BenchAccess::decodeKeypoints(*palm, palm->confThreshold);
+    auto decoded = std::make_shared<std::vector<palm_t>>(BenchAccess::candidates(*palm), BenchAccess::candidates(*palm) + n);
+    for (bool weighted : {false, true}) {
+        suite.add(weighted ? "palm/non_max_suppression_weighted" : "palm/non_max_suppression", [=] {
+            palm_t *cands = BenchAccess::candidates(*palm);
+            std::copy(decoded->begin(), decoded->end(), cands);
+            BenchAccess::nonMaxSuppression(*palm, cands, (int)decoded->size(), palm->nmsThreshold, weighted);
+        });
+    }
+
+    // Decode + NMS + packing; checkPalmPostprocessNoAlloc() holds it to 0 allocs/op.
+    suite.add("palm/postprocess", [=] {
+        palm_detection_result_t result;
+        BenchAccess::postprocess(*palm, result);
+    });
+
+    // Per-ROI crop setup and sampling as done by HandLandmark::run.
+    HandRoi roi; roi.xc = 0.55f; roi.yc = 0.5f; roi.w = 0.45f; roi.h = 0.6f; roi.rotation = 0.6f;
+    auto hand_in = std::make_shared<std::vector<float>>(224 * 224 * 3);
+    const tensor_dst_t hand_dst = {hand_in->data(), TENSOR_F32, 1.0f, 0};
+    suite.add("hand/affine_transform", [=] {
+        cv::Mat affine = getHandAffineTransform(roi, W, H, 224, 224);
+        cv::Mat affineInv;
+        cv::invertAffineTransform(affine, affineInv);
+    });
+    auto hand_inv = std::make_shared<std::vector<float>>(6);
+    suite.add("hand/affine_inverse", [=] {
+        getHandAffineInverse(roi, W, H, 224, 224, hand_inv->data());
+    });
+    suite.add("hand/affine_transform_warp", [=] {
+        float inv[6];
+        getHandAffineInverse(roi, W, H, 224, 224, inv);
+        warp_affine_to_rgb(bgrView(frame.data, W, H, frame.step), inv, hand_dst, 224, 224);
+    });
+
+    // Frame lifecycle with pyramid level 1: pooled (no heap use) vs plain.
+    auto frame_pool = std::make_shared<FramePool>();
+    frame_pool->reserve(2, W, H, IMAGE_BGR888);
+    const image_view_t view = bgrView(frame.data, W, H, frame.step);
+    suite.add("frame/pooled", [=] {
+        Frame *f;
+        FramePtr p = frame_pool->make(f, [] {});
+        f->view = view;
+        f->level(1);
+    });
+    suite.add("frame/heap", [=] {
+        auto f = std::make_shared<Frame>();
+        f->view = view;
+        f->level(1);
+    });
+
+    hand_landmark_result_t open_hand = syntheticHand(W * 0.5f, H * 0.5f, 200.0f, false);
+    suite.add("tracking/calculateRoiFromLandmarks", [=] {
+        HandRoi out;
+        RoiTracker::calculateRoiFromLandmarks(open_hand, out, W, H);
+    });
+
+    // Alternates open and pinched poses so the click branches are exercised.
+    auto worker = std::make_shared<InferenceWorker>();
+    auto pinch = std::make_shared<bool>(false);
+    hand_landmark_result_t pinched = syntheticHand(W * 0.5f, H * 0.5f, 200.0f, true);
+    suite.add("mouse/processMouseLogic", [=] {
+        *pinch = !*pinch;
+        BenchAccess::processMouseLogic(*worker, *pinch ? pinched : open_hand, W, H, 0);
+    });
+
+    // Landmark log: one frame appended, and one frame replayed through the
+    // cursor logic. The files are unlinked once open; the writer starts a new
+    // one every 64k frames so the run does not fill the disk.
+    landmark_log_record_t rec = {};
+    rec.hand_count = 1;
+    rec.hands[0].track_id = 0;
+    rec.hands[0].score = open_hand.score;
+    memcpy(rec.hands[0].joint, open_hand.joint, sizeof(rec.hands[0].joint));
+    const char *tmp = getenv("TMPDIR");
+    const std::string log_path = std::string(tmp && *tmp ? tmp : "/tmp") + "/bench_landmark_log.bin";
+    auto writer = std::make_shared<LandmarkLogWriter>();
+    if (writer->open(log_path, W, H)) {
+        unlink(log_path.c_str());
+        suite.add("log/append", [=]() mutable {
+            if (writer->count() >= 65536) {
+                writer->open(log_path, W, H);
+                unlink(log_path.c_str());
+            }
+            rec.timestamp_ns += 33333333;
+            writer->append(rec);
+        });
+    }
+    {
+        LandmarkLogWriter w;
+        if (w.open(log_path, W, H)) {
+            // Hand found, pinched now and then, and lost every 256 frames.
+            for (int i = 0; i < 4096; ++i) {
+                const hand_landmark_result_t &pose = (i & 31) < 4 ? pinched : open_hand;
+                memcpy(rec.hands[0].joint, pose.joint, sizeof(rec.hands[0].joint));
+                rec.timestamp_ns = (uint64_t)i * 33333333;
+                rec.primary_id = (i & 255) < 250 ? 0 : -1;
+                w.append(rec);
+            }
+            w.close();
+        }
+    }
+    auto reader = std::make_shared<LandmarkLogReader>();
+    if (reader->open(log_path) && reader->size()) {
+        unlink(log_path.c_str());
+        auto replay = std::make_shared<InferenceWorker>();
+        replay->resetCursor();
+        auto targets = std::make_shared<Mailbox<cursor_target_t>>();
+        auto next = std::make_shared<uint64_t>(0);
+        suite.add("log/replay_cursor", [=] {
+            const landmark_log_record_t &r = (*reader)[*next];
+            if (++*next == reader->size()) *next = 0;
+            hand_landmark_result_t results[MAX_HAND_NUM];
+            int n = landmarkLogResults(reader->header(), r, results);
+            replay->updateCursor(results, n, r.primary_id, W, H, r.timestamp_ns, *targets);
+        });
+    }
+
+    // One cursor tick (move plus an occasional click) written to /dev/null.
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        std::shared_ptr<MouseController> mouse(new MouseController(), [null_fd](MouseController *m) {
+            delete m;
+            close(null_fd);
+        });
+        mouse->attach(null_fd);
+        auto tick = std::make_shared<int>(0);
+        suite.add("mouse/move_flush", [=] {
+            int i = ++*tick;
+            mouse->move_absolute(100 + (i & 63), 200);
+            if ((i & 15) == 0) mouse->click_right();
+            mouse->flush();
+        });
+    }
+
+    // One cursor filter update per tracked frame, 30 fps timeline.
+    for (CursorFilterType type : {CursorFilterType::ONE_EURO, CursorFilterType::KALMAN}) {
+        std::shared_ptr<CursorFilter> filter(makeCursorFilter(type));
+        auto t = std::make_shared<double>(0.0);
+        suite.add(type == CursorFilterType::ONE_EURO ? "tracking/one_euro_update" : "tracking/kalman_update", [=] {
+            *t += 1.0 / 30.0;
+            fvec2 p = {400.0f + 100.0f * (float)std::sin(*t), 300.0f + 50.0f * (float)std::cos(*t)};
+            filter->update(p, *t);
+        });
+    }
+}
@@ -0,0 +1,60 @@
+// Microbenchmarks for the per-frame hot paths.
+//   BENCH [--filter=SUBSTR] [--format=table|csv|json] [--min-time=SEC]
+//         [--baseline=FILE.csv] [--palm-model=PATH] [--hand-model=PATH]
+// Save a --format=csv run and pass it back as --baseline to compare.
+#include "bench.h"
+#include "../core/app_config.h"
+#include <opencv2/core.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char **argv) {
+    std::string filter, baseline_path;
+    std::string palm_model = PALM_MODEL_PATH, hand_model = HAND_LANDMARK_MODEL_PATH;
+    BenchFormat format = BENCH_TABLE;
+    double min_time = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq), value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--filter") filter = value;
+        else if (key == "--baseline") baseline_path = value;
+        else if (key == "--palm-model") palm_model = value;
+        else if (key == "--hand-model") hand_model = value;
+        else if (key == "--min-time") min_time = std::atof(value.c_str());
+        else if (key == "--format" && value == "table") format = BENCH_TABLE;
+        else if (key == "--format" && value == "csv") format = BENCH_CSV;
+        else if (key == "--format" && value == "json") format = BENCH_JSON;
+        else {
+            fprintf(stderr, "Usage: %s [--filter=SUBSTR] [--format=table|csv|json] [--min-time=SEC]\n"
+                            "          [--baseline=FILE.csv] [--palm-model=PATH] [--hand-model=PATH]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> baseline;
+    if (!baseline_path.empty() && !loadBaseline(baseline_path, baseline)) {
+        fprintf(stderr, "Cannot read baseline %s\n", baseline_path.c_str());
+        return 1;
+    }
+
+    // Deterministic 800x600 BGR test pattern, the camera's default mode.
+    const int W = 800, H = 600;
+    cv::Mat frame(H, W, CV_8UC3);
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W * 3; ++x) frame.ptr<uint8_t>(y)[x] = (uint8_t)((x * 7 + y * 13) & 0xff);
+
+    if (!checkYuvKernels(frame) || !checkPalmReacquire() || !checkPalmPostprocessNoAlloc()) return 1;
+
+    BenchSuite suite;
+    addPreprocessBenches(suite, frame);
+    addKernelBenches(suite, frame);
+    addModelBenches(suite, frame, palm_model, hand_model);
+
+    std::vector<BenchResult> results;
+    suite.run(filter, min_time, results);
+    printResults(results, format, baseline);
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Model Invoke and full per-frame runs on synthetic input.
+#include "bench.h"
+#include "bench_access.h"
+#include <opencv2/core.hpp>
+#include <cstdio>
+#include <memory>
+
+void addModelBenches(BenchSuite &suite, const cv::Mat &frame,
+                     const std::string &palm_model, const std::string &hand_model) {
+    auto input = std::make_shared<Frame>();
+    input->image = frame;
+    input->view = bgrView(frame.data, frame.cols, frame.rows, frame.step);
+    input->mirrored = CAMERA_MIRROR;
+    input->sequence = 0;
+    input->timestamp_ns = 0;
+
+    auto palm = std::make_shared<PALM>();
+    try {
+        palm->loadModel(palm_model);
+        BenchAccess::fillInputs(BenchAccess::interpreter(*palm));
+        suite.add("palm/invoke", [=] { BenchAccess::interpreter(*palm).Invoke(); });
+        suite.add("palm/run", [=] {
+            palm_detection_result_t result;
+            palm->run(*input, result);
+        });
+    } catch (const std::exception &e) {
+        fprintf(stderr, "skipping palm model benchmarks: %s\n", e.what());
+    }
+
+    auto hand = std::make_shared<HandLandmark>();
+    try {
+        hand->loadModel(hand_model);
+        BenchAccess::fillInputs(BenchAccess::interpreter(*hand));
+        suite.add("hand/invoke", [=] { BenchAccess::interpreter(*hand).Invoke(); });
+
+        HandRoi roi; roi.xc = 0.55f; roi.yc = 0.5f; roi.w = 0.45f; roi.h = 0.6f; roi.rotation = 0.6f;
+        HandRoi roi2 = roi; roi2.xc = 0.3f; roi2.rotation = -0.3f;
+        std::vector<HandRoi> one = {roi}, two = {roi, roi2};
+        auto results = std::make_shared<std::vector<hand_landmark_result_t>>();
+        // Full runs with the motion gate off; the _still variant feeds the same
+        // frame with it on, so it measures the reuse path plus forced refreshes.
+        hand->motionThreshold = 0.0f;
+        suite.add("hand/run_1roi", [=] { hand->run(*input, one, *results, frame.cols, frame.rows); });
+        suite.add("hand/run_2roi", [=] { hand->run(*input, two, *results, frame.cols, frame.rows); });
+        suite.add("hand/run_1roi_still", [=] {
+            hand->motionThreshold = HAND_MOTION_THRESH;
+            hand->run(*input, one, *results, frame.cols, frame.rows);
+            hand->motionThreshold = 0.0f;
+        });
+        // Two hands, one still and one moving: the still one is reused
+        // between forced refreshes, so the number of ROIs needing the model
+        // changes every few frames while the ROI count does not.
+        std::vector<HandRoi> shifted = two;
+        shifted[1].xc += 0.15f;
+        auto moved = std::make_shared<bool>(false);
+        suite.add("hand/run_2roi_one_still", [=] {
+            *moved = !*moved;
+            hand->motionThreshold = HAND_MOTION_THRESH;
+            hand->run(*input, *moved ? shifted : two, *results, frame.cols, frame.rows);
+            hand->motionThreshold = 0.0f;
+        });
+    } catch (const std::exception &e) {
+        fprintf(stderr, "skipping hand model benchmarks: %s\n", e.what());
+    }
+}
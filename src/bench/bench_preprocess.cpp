@@ -0,0 +1,210 @@
+// Model input preparation: OpenCV chain vs fused kernels.
+#include "bench.h"
+#include "../models/preprocess.h"
+#include "../models/hand_landmark.h"
+#include "../core/frame_pyramid.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// The test frame as the camera would deliver it in YUV: full-range BT.601,
+// chroma averaged over 2x2. Planes are packed back to back.
+struct YuvFrame {
+    std::vector<uint8_t> data;
+    image_view_t view;
+};
+
+static std::shared_ptr<YuvFrame> makeYuv(const cv::Mat &bgr, ImageFormat format) {
+    const int W = bgr.cols, H = bgr.rows, CW = (W + 1) / 2, CH = (H + 1) / 2;
+    auto f = std::make_shared<YuvFrame>();
+    f->data.resize((size_t)W * H + (size_t)CW * CH * 2);
+    uint8_t *y = f->data.data(), *c = y + (size_t)W * H;
+    auto clamp8 = [](float v) { return (uint8_t)std::min(255.0f, std::max(0.0f, std::round(v))); };
+    for (int r = 0; r < H; ++r) {
+        const uint8_t *p = bgr.ptr<uint8_t>(r);
+        for (int x = 0; x < W; ++x)
+            y[r * W + x] = clamp8(0.299f * p[x * 3 + 2] + 0.587f * p[x * 3 + 1] + 0.114f * p[x * 3]);
+    }
+    for (int r = 0; r < CH; ++r) {
+        for (int x = 0; x < CW; ++x) {
+            float b = 0, g = 0, rr = 0;
+            int n = 0;
+            for (int dy = 0; dy < 2 && r * 2 + dy < H; ++dy) {
+                const uint8_t *p = bgr.ptr<uint8_t>(r * 2 + dy);
+                for (int dx = 0; dx < 2 && x * 2 + dx < W; ++dx, ++n) {
+                    b += p[(x * 2 + dx) * 3]; g += p[(x * 2 + dx) * 3 + 1]; rr += p[(x * 2 + dx) * 3 + 2];
+                }
+            }
+            b /= n; g /= n; rr /= n;
+            const uint8_t cb = clamp8(128.0f - 0.168736f * rr - 0.331264f * g + 0.5f * b);
+            const uint8_t cr = clamp8(128.0f + 0.5f * rr - 0.418688f * g - 0.081312f * b);
+            if (format == IMAGE_NV12) {
+                c[r * CW * 2 + x * 2] = cb;
+                c[r * CW * 2 + x * 2 + 1] = cr;
+            } else {
+                c[r * CW + x] = cb;
+                c[(size_t)CW * CH + r * CW + x] = cr;
+            }
+        }
+    }
+    f->view.format = format;
+    f->view.width = W;
+    f->view.height = H;
+    f->view.plane[0] = y;
+    f->view.stride[0] = W;
+    f->view.plane[1] = c;
+    f->view.stride[1] = format == IMAGE_NV12 ? CW * 2 : CW;
+    f->view.plane[2] = format == IMAGE_NV12 ? nullptr : c + (size_t)CW * CH;
+    f->view.stride[2] = format == IMAGE_NV12 ? 0 : CW;
+    return f;
+}
+
+static float maxDiff(const std::vector<float> &a, const std::vector<float> &b) {
+    float m = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) m = std::max(m, std::fabs(a[i] - b[i]));
+    return m;
+}
+
+bool checkYuvKernels(const cv::Mat &frame) {
+    const int W = frame.cols, H = frame.rows;
+    HandRoi roi; roi.xc = 0.8f; roi.yc = 0.5f; roi.w = 0.45f; roi.h = 0.6f; roi.rotation = 0.6f;
+    cv::Mat affine = getHandAffineTransform(roi, W, H, 224, 224), affineInv;
+    cv::invertAffineTransform(affine, affineInv);
+    float inv[6];
+    for (int k = 0; k < 6; ++k) inv[k] = (float)affineInv.at<double>(k / 3, k % 3);
+
+    // Fused sampling must match a full conversion followed by the BGR kernels.
+    bool ok = true;
+    for (ImageFormat format : {IMAGE_NV12, IMAGE_YUV420}) {
+        auto yuv = makeYuv(frame, format);
+        cv::Mat bgr(H, W, CV_8UC3);
+        convert_to_bgr(yuv->view, bgr.data, bgr.step);
+        const image_view_t ref = bgrView(bgr.data, W, H, bgr.step);
+
+        std::vector<float> a(224 * 224 * 3), b(224 * 224 * 3);
+        const tensor_dst_t da = {a.data(), TENSOR_F32, 1.0f, 0}, db = {b.data(), TENSOR_F32, 1.0f, 0};
+        float err = 0.0f;
+        for (int mirror = 0; mirror < 2; ++mirror) {
+            resize_to_rgb(yuv->view, mirror, da, 192, 192);
+            resize_to_rgb(ref, mirror, db, 192, 192);
+            err = std::max(err, maxDiff(a, b));
+        }
+        warp_affine_to_rgb(yuv->view, inv, da, 224, 224);
+        warp_affine_to_rgb(ref, inv, db, 224, 224);
+        err = std::max(err, maxDiff(a, b));
+
+        const bool pass = err < 1e-5f;
+        fprintf(stderr, "check %s: max difference to convert+BGR %g %s\n",
+                format == IMAGE_NV12 ? "nv12" : "yuv420", err, pass ? "ok" : "FAILED");
+        ok = ok && pass;
+    }
+    return ok;
+}
+
+void addPreprocessBenches(BenchSuite &suite, const cv::Mat &frame) {
+    const int W = frame.cols, H = frame.rows;
+    const image_view_t view = bgrView(frame.data, W, H, frame.step);
+    auto nv12 = makeYuv(frame, IMAGE_NV12);
+    auto i420 = makeYuv(frame, IMAGE_YUV420);
+
+    // Palm: cvtColor + convertTo on the full frame, then resize to 192x192.
+    auto palm_in = std::make_shared<std::vector<float>>(192 * 192 * 3);
+    const tensor_dst_t palm_dst = {palm_in->data(), TENSOR_F32, 1.0f, 0};
+    suite.add("preprocess/palm_opencv", [=] {
+        cv::Mat rgb, norm;
+        cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
+        rgb.convertTo(norm, CV_32FC3, 1.0f / 255.0f);
+        cv::Mat dst(192, 192, CV_32FC3, palm_in->data());
+        cv::resize(norm, dst, cv::Size(192, 192));
+    });
+    suite.add("preprocess/palm_fused", [=] {
+        resize_to_rgb(view, false, palm_dst, 192, 192);
+    });
+    // YUV capture: conversion inside the sampler vs converting the whole frame.
+    suite.add("preprocess/palm_nv12", [=] {
+        resize_to_rgb(nv12->view, false, palm_dst, 192, 192);
+    });
+    suite.add("preprocess/palm_yuv420", [=] {
+        resize_to_rgb(i420->view, false, palm_dst, 192, 192);
+    });
+    auto converted = std::make_shared<cv::Mat>(H, W, CV_8UC3);
+    suite.add("preprocess/palm_bgr_after_cvt", [=] {
+        convert_to_bgr(nv12->view, converted->data, converted->step);
+        resize_to_rgb(bgrView(converted->data, W, H, converted->step), false, palm_dst, 192, 192);
+    });
+
+    // Same kernel into a uint8 (scale 1/255) input: no float normalization.
+    auto palm_q = std::make_shared<std::vector<uint8_t>>(192 * 192 * 3);
+    const tensor_dst_t palm_qdst = {palm_q->data(), TENSOR_U8, 1.0f / 255.0f, 0};
+    suite.add("preprocess/palm_fused_u8", [=] {
+        resize_to_rgb(view, false, palm_qdst, 192, 192);
+    });
+
+    // Landmark: rotated 224x224 crop partly outside the frame.
+    HandRoi roi; roi.xc = 0.8f; roi.yc = 0.5f; roi.w = 0.45f; roi.h = 0.6f; roi.rotation = 0.6f;
+    auto hand_in = std::make_shared<std::vector<float>>(224 * 224 * 3);
+    const tensor_dst_t hand_dst = {hand_in->data(), TENSOR_F32, 1.0f, 0};
+    cv::Mat affine = getHandAffineTransform(roi, W, H, 224, 224);
+    suite.add("preprocess/landmark_opencv", [=] {
+        cv::Mat crop_bgr, crop_rgb;
+        cv::warpAffine(frame, crop_bgr, affine, cv::Size(224, 224), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+        cv::cvtColor(crop_bgr, crop_rgb, cv::COLOR_BGR2RGB);
+        cv::Mat dst(224, 224, CV_32FC3, hand_in->data());
+        crop_rgb.convertTo(dst, CV_32FC3, 1.0f / 255.0f);
+    });
+    suite.add("preprocess/landmark_fused", [=] {
+        cv::Mat affineInv;
+        cv::invertAffineTransform(affine, affineInv);
+        float inv[6];
+        for (int k = 0; k < 6; ++k) inv[k] = (float)affineInv.at<double>(k / 3, k % 3);
+        warp_affine_to_rgb(view, inv, hand_dst, 224, 224);
+    });
+    float inv[6];
+    cv::Mat affineInv;
+    cv::invertAffineTransform(affine, affineInv);
+    for (int k = 0; k < 6; ++k) inv[k] = (float)affineInv.at<double>(k / 3, k % 3);
+    const std::vector<float> inv_v(inv, inv + 6);
+    suite.add("preprocess/landmark_nv12", [=] {
+        warp_affine_to_rgb(nv12->view, inv_v.data(), hand_dst, 224, 224);
+    });
+    suite.add("preprocess/landmark_yuv420", [=] {
+        warp_affine_to_rgb(i420->view, inv_v.data(), hand_dst, 224, 224);
+    });
+
+    // Pyramid: building every level of a new frame, then the samplers on a
+    // level that is already built (what the second consumer of a frame pays).
+    suite.add("preprocess/pyramid_build", [=] {
+        FramePyramid p;
+        p.level(view, FramePyramid::kLevels - 1);
+    });
+    suite.add("preprocess/pyramid_build_nv12", [=] {
+        FramePyramid p;
+        p.level(nv12->view, FramePyramid::kLevels - 1);
+    });
+    auto pyramid = std::make_shared<FramePyramid>();
+    const float palm_scale = std::min(W / 192.0f, H / 192.0f);
+    pyramid->level(view, FramePyramid::kLevels - 1);
+    suite.add("preprocess/palm_pyramid", [=] {
+        resize_to_rgb(pyramid->level(view, pyramidLevelFor(palm_scale)), false, palm_dst, 192, 192);
+    });
+
+    // A hand filling most of the frame: ~3 frame pixels per input pixel.
+    HandRoi big; big.xc = 0.5f; big.yc = 0.5f; big.w = 0.85f; big.h = 1.1f; big.rotation = 0.3f;
+    cv::Mat big_inv_m;
+    cv::invertAffineTransform(getHandAffineTransform(big, W, H, 224, 224), big_inv_m);
+    std::vector<float> big_inv(6);
+    for (int k = 0; k < 6; ++k) big_inv[k] = (float)big_inv_m.at<double>(k / 3, k % 3);
+    suite.add("preprocess/landmark_large_full", [=] {
+        warp_affine_to_rgb(view, big_inv.data(), hand_dst, 224, 224);
+    });
+    suite.add("preprocess/landmark_large_pyramid", [=] {
+        const int k = pyramidLevelFor(affineScale(big_inv.data()));
+        float m[6];
+        affineToLevel(big_inv.data(), k, m);
+        warp_affine_to_rgb(pyramid->level(view, k), m, hand_dst, 224, 224);
+    });
+}
@@ -3,7 +3,10 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <stdexcept>
+#include <algorithm>
 #include <libcamera/control_ids.h>
+#include "../core/trace.h"
+#include "../core/clock.h"
 
 SimpleCamera::SimpleCamera() {}
 SimpleCamera::~SimpleCamera() { closeCamera(); }
@@ -22,8 +25,33 @@ bool SimpleCamera::initCamera() {
 void SimpleCamera::configureStill(uint32_t width, uint32_t height) {
     config_ = camera_->generateConfiguration({ StreamRole::VideoRecording });
     if (width && height) config_->at(0).size = libcamera::Size(width, height);
-    config_->at(0).pixelFormat = formats::RGB888;
+    // YUV keeps the ISP output at 1.5 bytes/pixel; the models convert only the
+    // pixels they sample.
+    const libcamera::PixelFormat want = pixelFormat == IMAGE_NV12 ? formats::NV12
+                                      : pixelFormat == IMAGE_YUV420 ? formats::YUV420 : formats::RGB888;
+    config_->at(0).pixelFormat = want;
+    if (pixelFormat != IMAGE_BGR888) config_->at(0).colorSpace = ColorSpace::Sycc;
+    // Frames stay queued to the camera only while no stage holds them.
+    config_->at(0).bufferCount = CAMERA_BUFFER_COUNT;
     if (config_->validate() == CameraConfiguration::Invalid) throw std::runtime_error("Invalid config");
+    if (config_->at(0).pixelFormat != want)
+        throw std::runtime_error("Camera does not support " + want.toString());
+}
+
+// One mapping per dmabuf, covering every plane that lives in it.
+bool SimpleCamera::mapBuffer(const FrameBuffer *buffer) {
+    std::map<int, size_t> lengths;
+    for (auto &plane : buffer->planes()) {
+        size_t &len = lengths[plane.fd.get()];
+        len = std::max(len, (size_t)plane.offset + plane.length);
+    }
+    for (auto &it : lengths) {
+        if (mappedBuffers_.count(it.first)) continue;
+        void *mem = mmap(NULL, it.second, PROT_READ, MAP_SHARED, it.first, 0);
+        if (mem == MAP_FAILED) { std::cerr << "mmap of camera buffer failed\n"; return false; }
+        mappedBuffers_[it.first] = {mem, it.second};
+    }
+    return true;
 }
 
 bool SimpleCamera::startCamera() {
@@ -38,15 +66,15 @@ bool SimpleCamera::startCamera() {
         if (!req) return false;
         auto &buffers = allocator_->buffers(config_->at(0).stream());
         req->addBuffer(config_->at(0).stream(), buffers[i].get());
-        for (auto &plane : buffers[i]->planes()) {
-            void *mem = mmap(NULL, plane.length, PROT_READ, MAP_SHARED, plane.fd.get(), 0);
-            mappedBuffers_[plane.fd.get()] = {mem, plane.length};
-        }
+        if (!mapBuffer(buffers[i].get())) return false;
         requests_.push_back(std::move(req));
     }
 
+    // A frame holds its request buffer, so there are never more frames alive.
+    pool_.reserve((int)requests_.size(), (int)width(), (int)height(), pixelFormat);
+
     ControlList controls(camera_->controls());
-    int64_t frame_time = 1000000 / 30;
+    int64_t frame_time = 1000000 / frameRate;
     controls.set(controls::FrameDurationLimits, {frame_time, frame_time});
 
     if (camera_->start(&controls)) return false;
@@ -62,16 +90,74 @@ bool SimpleCamera::readFrame(LibcameraOutData &out) {
     auto &buffers = req->buffers();
     for (auto &it : buffers) {
         FrameBuffer *buffer = it.second; // Đây là libcamera::FrameBuffer (OK)
-        auto &plane = buffer->planes()[0];
-        out.imageData = (uint8_t*)mappedBuffers_[plane.fd.get()].first;
-        out.size = plane.length;
+        auto &planes = buffer->planes();
+        const uint32_t stride = config_->at(0).stride;
+        const uint32_t h = height();
+        for (int p = 0; p < 3; ++p) {
+            out.planes[p] = nullptr;
+            out.strides[p] = 0;
+        }
+        for (size_t p = 0; p < planes.size() && p < 3; ++p)
+            out.planes[p] = (const uint8_t *)mappedBuffers_[planes[p].fd.get()].first + planes[p].offset;
+        out.imageData = (uint8_t *)out.planes[0];
+        out.size = planes[0].length;
+        if (pixelFormat != IMAGE_BGR888) {
+            // Chroma is subsampled 2x2; NV12 interleaves Cb,Cr at the luma stride.
+            const uint32_t cstride = pixelFormat == IMAGE_NV12 ? stride : stride / 2;
+            // Some drivers describe the whole frame as one plane.
+            if (planes.size() == 1) out.planes[1] = out.planes[0] + (size_t)stride * h;
+            if (pixelFormat == IMAGE_YUV420 && planes.size() < 3)
+                out.planes[2] = out.planes[1] + (size_t)cstride * ((h + 1) / 2);
+            out.strides[1] = out.strides[2] = cstride;
+        }
+        out.strides[0] = stride;
+        out.sequence = buffer->metadata().sequence;
+        out.timestamp = buffer->metadata().timestamp;
     }
+    // Gaps in the sensor sequence are frames lost because no buffer was queued.
+    if (have_sequence_ && out.sequence > last_sequence_ + 1)
+        dropped_frames_ += out.sequence - last_sequence_ - 1;
+    last_sequence_ = out.sequence;
+    have_sequence_ = true;
+    out.stride = config_->at(0).stride;
     out.request = (uint64_t)req;
     requestQueue.pop();
     return true;
 }
 
+// Wraps the mmapped buffer in place; the request is re-queued once every
+// stage has dropped its reference.
+bool SimpleCamera::grab(FramePtr &frame) {
+    LibcameraOutData fd;
+    if (!readFrame(fd)) return false;
+    Frame *f;
+    frame = pool_.make(f, [this, fd]() mutable { returnFrameBuffer(fd); });
+    const int w = (int)width(), h = (int)height();
+    if (pixelFormat == IMAGE_BGR888) {
+        f->image = cv::Mat(h, w, CV_8UC3, fd.imageData, fd.stride ? fd.stride : w * 3);
+        f->view = bgrView(f->image.data, w, h, f->image.step);
+    } else {
+        f->image = cv::Mat(h, w, CV_8UC1, fd.imageData, fd.stride ? fd.stride : w);
+        f->view.format = pixelFormat;
+        f->view.width = w;
+        f->view.height = h;
+        for (int p = 0; p < 3; ++p) {
+            f->view.plane[p] = fd.planes[p];
+            f->view.stride[p] = fd.strides[p];
+        }
+        f->view.stride[0] = f->image.step;
+    }
+    f->mirrored = mirror;
+    f->sequence = fd.sequence;
+    f->timestamp_ns = fd.timestamp ? fd.timestamp : monotonicNowNs();
+    return true;
+}
+
+uint32_t SimpleCamera::width() const { return config_ ? config_->at(0).size.width : 0; }
+uint32_t SimpleCamera::height() const { return config_ ? config_->at(0).size.height : 0; }
+
 void SimpleCamera::returnFrameBuffer(LibcameraOutData &frameData) {
+    if (!camera_started_) return;
     Request *req = (Request*)frameData.request;
     req->reuse(Request::ReuseBuffers);
     camera_->queueRequest(req);
@@ -94,6 +180,15 @@ void SimpleCamera::closeCamera() {
 
 void SimpleCamera::requestComplete(Request *request) {
     if (request->status() != Request::RequestCancelled) {
+        if (traceEnabled()) {
+            // Sensor timestamp to completion on the libcamera thread.
+            uint64_t now = traceNowNs();
+            for (auto &it : request->buffers()) {
+                uint64_t ts = it.second->metadata().timestamp;
+                if (ts && ts < now) traceRecord("camera.complete", ts, now);
+                break;
+            }
+        }
         std::lock_guard<std::mutex> lock(queue_mutex_);
         requestQueue.push(request);
     }
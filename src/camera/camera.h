@@ -1,7 +1,8 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include "../core/types.h" 
+#include "frame_source.h"
+#include "../core/frame_pool.h"
 #include <libcamera/libcamera.h>
 #include <libcamera/camera_manager.h>
 #include <libcamera/framebuffer_allocator.h>
@@ -12,10 +13,11 @@
 #include <queue>
 #include <mutex>
 #include <map>
+#include <atomic>
 
 using namespace libcamera;
 
-class SimpleCamera {
+class SimpleCamera : public FrameSource {
 public:
     SimpleCamera();
     ~SimpleCamera();
@@ -27,6 +29,17 @@ public:
     void stopCamera();
     void closeCamera();
 
+    bool start() override { return startCamera(); }
+    void stop() override { stopCamera(); }
+    bool grab(FramePtr &frame) override;
+    uint64_t droppedFrames() const override { return dropped_frames_; }
+    uint64_t poolMisses() const override { return pool_.misses(); }
+    uint32_t width() const override;
+    uint32_t height() const override;
+
+    int frameRate = CAMERA_FPS;
+    ImageFormat pixelFormat = IMAGE_NV12;   // set before configureStill
+
 private:
     void requestComplete(Request *request);
     std::unique_ptr<CameraManager> cm;
@@ -34,10 +47,15 @@ private:
     std::unique_ptr<CameraConfiguration> config_;
     std::unique_ptr<FrameBufferAllocator> allocator_;
     std::vector<std::unique_ptr<Request>> requests_;
-    std::map<int, std::pair<void*, unsigned int>> mappedBuffers_;
+    bool mapBuffer(const FrameBuffer *buffer);
+    std::map<int, std::pair<void*, size_t>> mappedBuffers_;
     std::queue<Request*> requestQueue;
     std::mutex queue_mutex_;
     bool camera_acquired_ = false;
-    bool camera_started_ = false;
+    std::atomic<bool> camera_started_{false};
+    bool have_sequence_ = false;
+    uint32_t last_sequence_ = 0;
+    std::atomic<uint64_t> dropped_frames_{0};
+    FramePool pool_;    // sized from the request buffers in startCamera
 };
 #endif
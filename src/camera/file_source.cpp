@@ -0,0 +1,101 @@
+#include "file_source.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include "../core/clock.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <sys/stat.h>
+
+FileFrameSource::FileFrameSource(const std::string &path, bool realtime, bool loop)
+    : path_(path), realtime_(realtime), loop_(loop) {}
+
+bool FileFrameSource::open() {
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) {
+        std::cerr << "Source Error: cannot access " << path_ << std::endl;
+        return false;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        cv::glob(path_ + "/*", files_);
+        std::sort(files_.begin(), files_.end());
+    } else if (video_.open(path_)) {
+        double rate = video_.get(cv::CAP_PROP_FPS);
+        if (rate > 0) fps = rate;
+    } else {
+        std::cerr << "Source Error: cannot open video " << path_ << std::endl;
+        return false;
+    }
+    // The first frame fixes the pipeline resolution.
+    if (!readNext(pending_)) {
+        std::cerr << "Source Error: no readable frames in " << path_ << std::endl;
+        return false;
+    }
+    width_ = pending_.cols;
+    height_ = pending_.rows;
+    pool_.reserve(FILE_SOURCE_FRAMES, width_, height_, IMAGE_BGR888, (size_t)width_ * height_ * 3);
+    return true;
+}
+
+bool FileFrameSource::start() {
+    if (!width_) return false;
+    start_time_ = std::chrono::steady_clock::now();
+    start_ns_ = monotonicNowNs();
+    return true;
+}
+
+bool FileFrameSource::readNext(cv::Mat &img) {
+    if (video_.isOpened()) return video_.read(img) && !img.empty();
+    while (next_file_ < files_.size()) {
+        img = cv::imread(files_[next_file_++], cv::IMREAD_COLOR);
+        if (!img.empty()) return true;
+    }
+    return false;
+}
+
+bool FileFrameSource::rewind() {
+    if (video_.isOpened()) {
+        video_.release();
+        return video_.open(path_);
+    }
+    next_file_ = 0;
+    return true;
+}
+
+bool FileFrameSource::grab(FramePtr &frame) {
+    if (stopped_ || finished_) return false;
+
+    if (!pending_.empty()) {
+        decoded_ = pending_;
+        pending_ = cv::Mat();
+    } else if (!readNext(decoded_) && !(loop_ && rewind() && readNext(decoded_))) {
+        finished_ = true;
+        return false;
+    }
+    // Frames get pooled pixels; decoded_ is never shared, so the video decoder
+    // keeps writing into the same buffer.
+    void *pixels = pool_.acquireImage((size_t)width_ * height_ * 3);
+    cv::Mat img((int)height_, (int)width_, CV_8UC3, pixels);
+    if ((uint32_t)decoded_.cols != width_ || (uint32_t)decoded_.rows != height_)
+        cv::resize(decoded_, img, img.size());
+    else
+        decoded_.copyTo(img);
+
+    // Frames are stamped on the recorded timeline, so filters see the original
+    // frame spacing even when replaying as fast as possible.
+    const uint64_t offset_ns = (uint64_t)(sequence_ * 1e9 / fps);
+    if (realtime_) {
+        auto due = start_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::nanoseconds(offset_ns));
+        std::this_thread::sleep_until(due);
+    }
+
+    Frame *f;
+    frame = pool_.make(f, [this, pixels]() { pool_.releaseImage(pixels); });
+    f->image = img;
+    f->view = bgrView(img.data, img.cols, img.rows, img.step);
+    f->mirrored = mirror;
+    f->timestamp_ns = start_ns_ + offset_ns;
+    f->sequence = sequence_++;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef FILE_SOURCE_H
+#define FILE_SOURCE_H
+
+#include "frame_source.h"
+#include "../core/frame_pool.h"
+#include <opencv2/videoio.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// Replays a video file (anything cv::VideoCapture opens) or a directory of
+// images. Realtime pacing delivers frames at the recorded rate; otherwise they
+// come as fast as the pipeline consumes them.
+class FileFrameSource : public FrameSource {
+public:
+    FileFrameSource(const std::string &path, bool realtime, bool loop = false);
+    bool open();
+
+    bool start() override;
+    void stop() override { stopped_ = true; }
+    bool grab(FramePtr &frame) override;
+    bool finished() const override { return finished_; }
+    bool paced() const override { return realtime_; }
+    uint32_t width() const override { return width_; }
+    uint32_t height() const override { return height_; }
+    uint64_t poolMisses() const override { return pool_.misses(); }
+
+    double fps = 30.0; // image directories; videos use their own rate
+
+private:
+    bool readNext(cv::Mat &img);
+    bool rewind();
+
+    std::string path_;
+    bool realtime_;
+    bool loop_;
+    bool stopped_ = false;
+    bool finished_ = false;
+
+    cv::VideoCapture video_;
+    std::vector<std::string> files_;
+    size_t next_file_ = 0;
+    cv::Mat pending_;
+    cv::Mat decoded_;   // decoder output, copied into pooled frame pixels
+    FramePool pool_;
+
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint64_t sequence_ = 0;
+    std::chrono::steady_clock::time_point start_time_;
+    uint64_t start_ns_ = 0;
+};
+
+#endif
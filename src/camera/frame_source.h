@@ -0,0 +1,28 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include "../core/types.h"
+
+// Anything CaptureWorker can pull frames from.
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    // Next frame if one is ready; false otherwise (and at end of input).
+    virtual bool grab(FramePtr &frame) = 0;
+    // No more frames will come.
+    virtual bool finished() const { return false; }
+    // Frames arrive at their own rate. Unpaced sources are throttled to the
+    // consumer instead so that no frame is skipped.
+    virtual bool paced() const { return true; }
+    virtual uint64_t droppedFrames() const { return 0; }
+    // Frame allocations the source's FramePool could not serve.
+    virtual uint64_t poolMisses() const { return 0; }
+    virtual uint32_t width() const = 0;
+    virtual uint32_t height() const = 0;
+
+    bool mirror = CAMERA_MIRROR;
+};
+
+#endif
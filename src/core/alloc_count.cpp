@@ -0,0 +1,48 @@
+// Counts every heap allocation of the process by interposing the glibc
+// allocator; operator new, OpenCV and TFLite all end up here. Linked into
+// BENCH, and into FINAL only with `make ALLOC_STATS=1`: every allocation
+// pays an atomic add on one shared counter.
+#include "alloc_count.h"
+#include <atomic>
+#include <cerrno>
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+}
+
+static std::atomic<uint64_t> g_allocs{0};
+static std::atomic<uint64_t> g_bytes{0};
+
+static inline void count(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t heapAllocCount() { return g_allocs.load(std::memory_order_relaxed); }
+uint64_t heapAllocBytes() { return g_bytes.load(std::memory_order_relaxed); }
+
+extern "C" {
+void *malloc(size_t n) { count(n); return __libc_malloc(n); }
+void *calloc(size_t k, size_t n) { count(k * n); return __libc_calloc(k, n); }
+void *realloc(void *p, size_t n) { count(n); return __libc_realloc(p, n); }
+void *memalign(size_t a, size_t n) { count(n); return __libc_memalign(a, n); }
+// __libc_memalign rounds a bad alignment up; these two must refuse it.
+void *aligned_alloc(size_t a, size_t n) {
+    if (!a || (a & (a - 1))) { errno = EINVAL; return nullptr; }
+    count(n);
+    return __libc_memalign(a, n);
+}
+int posix_memalign(void **out, size_t a, size_t n) {
+    if (a % sizeof(void *) || (a & (a - 1))) return EINVAL;
+    count(n);
+    void *p = __libc_memalign(a, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+}
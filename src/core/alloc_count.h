@@ -0,0 +1,11 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <stdint.h>
+
+// Heap allocations made by any thread since start-up (core/alloc_count.cpp,
+// only linked when ALLOC_STATS is set or into the bench).
+uint64_t heapAllocCount();
+uint64_t heapAllocBytes();
+
+#endif
@@ -5,8 +5,24 @@
 #define PALM_MODEL_PATH "./models/palm_detection_lite.tflite"
 #define HAND_LANDMARK_MODEL_PATH "./models/hand_landmark_lite.tflite"
 
+// Camera
+#define CAMERA_BUFFER_COUNT 8
+// Frames alive at once from a file source (camera frames are bounded by the
+// buffer count); more still work, from the heap
+#define FILE_SOURCE_FRAMES 12
+#define CAMERA_FPS 30
+
+// Settings written by --tune and loaded at startup (--config overrides)
+#define TUNED_CONFIG_PATH "./hand_mouse.conf"
+#define CAMERA_MIRROR true
+
+// Inference threads per interpreter
+#define PALM_NUM_THREADS 2
+#define HAND_NUM_THREADS 3
+
 // Constants
 #define MAX_PALM_NUM 4
+#define MAX_HAND_NUM 2
 #define HAND_JOINT_NUM 21
 
 // Screen & Mouse Config
@@ -15,6 +31,47 @@
 #define MOUSE_REGION_W 560
 #define MOUSE_REGION_H 315
 
+// Preview window; `make HEADLESS=1` builds without it (and without HighGUI)
+#ifndef ENABLE_PREVIEW
+#define ENABLE_PREVIEW 1
+#endif
+#define PREVIEW_FPS 15
+
+// Whole-process heap allocation counts in the headless report; `make
+// ALLOC_STATS=1` links the malloc interposer that provides them
+#ifndef ALLOC_STATS
+#define ALLOC_STATS 0
+#endif
+
+// Tracing (--trace=FILE); 0 compiles out the spans and every hand-timed
+// record (traceEnabled() is then constant false)
+#ifndef ENABLE_TRACING
+#define ENABLE_TRACING 1
+#endif
+#define TRACE_RING_EVENTS 16384
+
+// Palm scheduling while searching: busy fraction allowed with no hand in
+// view, longest gap between runs, empty runs before the gap doubles
+#define PALM_CPU_BUDGET 0.25f
+#define PALM_MAX_LATENCY_MS 500
+#define PALM_BACKOFF_AFTER 2
+
+// Landmark reuse for still hands: ROI thumbnail side, mean absolute
+// difference (0-255) below which the crop counts as unchanged, reuses in a
+// row before a forced refresh
+#define HAND_MOTION_THUMB 16
+#define HAND_MOTION_THRESH 4.0f
+#define HAND_MAX_REUSE 4
+
+// Cursor filter (pixel units, rates in Hz)
+#define ONE_EURO_MIN_CUTOFF 1.0f
+#define ONE_EURO_BETA 0.05f
+#define ONE_EURO_D_CUTOFF 1.0f
+#define KALMAN_ACCEL_NOISE 3000.0f
+#define KALMAN_MEAS_NOISE 3.0f
+#define CURSOR_MAX_LEAD_MS 120
+#define CURSOR_OUTPUT_HZ 120
+
 // Thresholds
 #define THRESH_TRACK_ENTER 0.5f
 #define THRESH_TRACK_EXIT  0.4f
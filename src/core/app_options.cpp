@@ -0,0 +1,239 @@
+#include "app_options.h"
+#include "thread_placement.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+static bool parseBackend(const std::string &v, InferenceBackend &out) {
+    if (v == "default") out = InferenceBackend::DEFAULT;
+    else if (v == "cpu") out = InferenceBackend::CPU;
+    else if (v == "xnnpack") out = InferenceBackend::XNNPACK;
+    else return false;
+    return true;
+}
+
+const char *backendName(InferenceBackend b) {
+    switch (b) {
+    case InferenceBackend::CPU: return "cpu";
+    case InferenceBackend::XNNPACK: return "xnnpack";
+    default: return "default";
+    }
+}
+
+static bool parsePixelFormat(const std::string &v, ImageFormat &out) {
+    if (v == "bgr") out = IMAGE_BGR888;
+    else if (v == "nv12") out = IMAGE_NV12;
+    else if (v == "yuv420") out = IMAGE_YUV420;
+    else return false;
+    return true;
+}
+
+static bool parseFraction(const std::string &v, float &out) {
+    char *end = nullptr;
+    float f = std::strtof(v.c_str(), &end);
+    if (v.empty() || *end || !(f > 0.0f && f <= 1.0f)) return false;
+    out = f;
+    return true;
+}
+
+static bool parseNonNegative(const std::string &v, float &out) {
+    char *end = nullptr;
+    float f = std::strtof(v.c_str(), &end);
+    if (v.empty() || *end || !(f >= 0.0f)) return false;
+    out = f;
+    return true;
+}
+
+static bool parseCursorFilter(const std::string &v, CursorFilterType &out) {
+    if (v == "none") out = CursorFilterType::NONE;
+    else if (v == "one-euro") out = CursorFilterType::ONE_EURO;
+    else if (v == "kalman") out = CursorFilterType::KALMAN;
+    else return false;
+    return true;
+}
+
+static bool parseBool(const std::string &v, bool &out) {
+    if (v.empty() || v == "1" || v == "true" || v == "on") out = true;
+    else if (v == "0" || v == "false" || v == "off") out = false;
+    else return false;
+    return true;
+}
+
+static bool parseInt(const std::string &v, int &out, int min_value) {
+    char *end = nullptr;
+    long n = std::strtol(v.c_str(), &end, 10);
+    if (v.empty() || *end || n < min_value) return false;
+    out = (int)n;
+    return true;
+}
+
+static bool parsePace(const std::string &v, bool &realtime) {
+    if (v == "realtime") realtime = true;
+    else if (v == "fast") realtime = false;
+    else return false;
+    return true;
+}
+
+bool applyOption(AppOptions &opt, const std::string &key, const std::string &value) {
+    if (key == "palm-model") { opt.palm_model = value; return !value.empty(); }
+    if (key == "hand-model") { opt.hand_model = value; return !value.empty(); }
+    if (key == "palm-backend") return parseBackend(value, opt.palm_backend);
+    if (key == "hand-backend") return parseBackend(value, opt.hand_backend);
+    if (key == "palm-fp16") return parseBool(value, opt.palm_fp16);
+    if (key == "hand-fp16") return parseBool(value, opt.hand_fp16);
+    if (key == "palm-weighted-nms") return parseBool(value, opt.palm_weighted_nms);
+    if (key == "palm-budget") return parseFraction(value, opt.palm_budget);
+    if (key == "palm-latency-ms") return parseInt(value, opt.palm_latency_ms, 0);
+    if (key == "palm-threads") return parseInt(value, opt.palm_threads, 1);
+    if (key == "hand-threads") return parseInt(value, opt.hand_threads, 1);
+    if (key == "hand-motion-thresh") return parseNonNegative(value, opt.hand_motion_thresh);
+    if (key == "hand-max-reuse") return parseInt(value, opt.hand_max_reuse, 0);
+    if (key == "source") { opt.source = value; return !value.empty(); }
+    if (key == "pace") return parsePace(value, opt.replay_realtime);
+    if (key == "loop") return parseBool(value, opt.replay_loop);
+    if (key == "source-fps") return parseInt(value, opt.source_fps, 1);
+    if (key == "width") return parseInt(value, opt.width, 16);
+    if (key == "height") return parseInt(value, opt.height, 16);
+    if (key == "camera-fps") return parseInt(value, opt.camera_fps, 1);
+    if (key == "pixel-format") return parsePixelFormat(value, opt.pixel_format);
+    if (key == "mouse") return parseBool(value, opt.mouse);
+    if (key == "headless") return parseBool(value, opt.headless);
+    if (key == "preview-fps") return parseInt(value, opt.preview_fps, 0);
+    if (key == "cursor-filter") return parseCursorFilter(value, opt.cursor_filter);
+    if (key == "cursor-predict") return parseBool(value, opt.cursor_predict);
+    if (key == "cursor-hz") return parseInt(value, opt.cursor_hz, 1);
+    if (key == "trace") { opt.trace_path = value; return !value.empty(); }
+    if (key == "record") { opt.record_path = value; return !value.empty(); }
+    if (key == "replay") { opt.replay_path = value; return !value.empty(); }
+    if (key == "cpus-camera") return parseCpuList(value, opt.cpus_camera);
+    if (key == "cpus-capture") return parseCpuList(value, opt.cpus_capture);
+    if (key == "cpus-palm") return parseCpuList(value, opt.cpus_palm);
+    if (key == "cpus-inference") return parseCpuList(value, opt.cpus_inference);
+    if (key == "cpus-cursor") return parseCpuList(value, opt.cpus_cursor);
+    if (key == "cpus-render") return parseCpuList(value, opt.cpus_render);
+    if (key == "rt-priority") return parseInt(value, opt.rt_priority, 0) && opt.rt_priority <= 99;
+    if (key == "config") return !value.empty();   // handled by parseOptions
+    if (key == "tune") { opt.tune_path = value.empty() ? TUNED_CONFIG_PATH : value; return true; }
+    if (key == "tune-seconds") return parseInt(value, opt.tune_seconds, 2);
+    return false;
+}
+
+bool loadOptionsFile(AppOptions &opt, const std::string &path, bool required) {
+    std::ifstream in(path);
+    if (!in) {
+        if (required) std::cerr << "Cannot read settings file " << path << "\n";
+        return !required;
+    }
+    std::string line;
+    for (int n = 1; std::getline(in, line); ++n) {
+        size_t b = line.find_first_not_of(" \t");
+        if (b == std::string::npos || line[b] == '#') continue;
+        size_t e = line.find_last_not_of(" \t\r");
+        line = line.substr(b, e - b + 1);
+        size_t eq = line.find('=');
+        std::string key = line.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : line.substr(eq + 1);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        if (key == "config" || key == "tune" || !applyOption(opt, key, value)) {
+            std::cerr << path << ":" << n << ": invalid setting: " << line << "\n";
+            return false;
+        }
+    }
+    opt.config_path = path;
+    return true;
+}
+
+bool saveTunedOptions(const AppOptions &opt, const std::string &path, const std::string &comment) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write settings file " << path << "\n";
+        return false;
+    }
+    out << "# Written by --tune; loaded at startup, flags override it.\n";
+    if (!comment.empty()) out << "# " << comment << "\n";
+    out << "palm-backend=" << backendName(opt.palm_backend) << "\n"
+        << "hand-backend=" << backendName(opt.hand_backend) << "\n"
+        << "palm-threads=" << opt.palm_threads << "\n"
+        << "hand-threads=" << opt.hand_threads << "\n";
+    if (opt.source == "camera") {
+        out << "width=" << opt.width << "\n"
+            << "height=" << opt.height << "\n"
+            << "camera-fps=" << opt.camera_fps << "\n";
+    }
+    return (bool)out;
+}
+
+bool parseOptions(int argc, char **argv, AppOptions &opt) {
+    std::string config = TUNED_CONFIG_PATH;
+    bool required = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--config=") == 0) {
+            config = arg.substr(9);
+            required = true;
+        }
+    }
+    if (config != "none" && !loadOptionsFile(opt, config, required)) return false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") { printUsage(argv[0]); return false; }
+        if (arg.compare(0, 2, "--") != 0) {
+            std::cerr << "Unexpected argument: " << arg << "\n";
+            printUsage(argv[0]);
+            return false;
+        }
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (!applyOption(opt, key, value)) {
+            std::cerr << "Invalid option: " << arg << "\n";
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void printUsage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --palm-model=PATH, --hand-model=PATH   TFLite models (float, uint8 or int8)\n"
+              << "  --palm-backend=B, --hand-backend=B     default | cpu | xnnpack\n"
+              << "  --palm-fp16, --hand-fp16               allow fp16 inference (XNNPACK)\n"
+              << "  --palm-threads=N, --hand-threads=N     interpreter threads\n"
+              << "  --palm-weighted-nms                    blend overlapping palm boxes by score\n"
+              << "  --palm-budget=F                        palm busy fraction allowed with no hand (0..1]\n"
+              << "  --palm-latency-ms=N                    longest gap between palm runs while searching\n"
+              << "  --hand-motion-thresh=F                 reuse landmarks while the hand crop changes less\n"
+              << "                                         than F (mean abs difference, 0-255; 0 = off)\n"
+              << "  --hand-max-reuse=N                     forced landmark run after N reuses\n"
+              << "  --source=camera|FILE|DIR               camera, video file or image directory\n"
+              << "  --pace=realtime|fast                   replay speed for file sources\n"
+              << "  --loop                                 restart file sources at the end\n"
+              << "  --source-fps=N                         frame rate of an image directory\n"
+              << "  --width=N, --height=N                  camera resolution\n"
+              << "  --camera-fps=N                         camera frame rate\n"
+              << "  --pixel-format=nv12|yuv420|bgr         camera output; YUV is converted only where sampled\n"
+              << "  --mouse=off                            do not create the uinput mouse\n"
+              << "  --headless                             no window; print throughput instead\n"
+              << "  --preview-fps=N                        preview redraw rate (0 = every frame)\n"
+              << "  --cursor-filter=F                      none | one-euro | kalman\n"
+              << "  --cursor-predict=on|off                extrapolate the cursor by the pipeline latency\n"
+              << "                                         (off: interpolate between measurements)\n"
+              << "  --cursor-hz=N                          cursor output rate\n"
+              << "  --trace=FILE                           record stage spans; Chrome trace JSON written\n"
+              << "                                         on SIGUSR1 and at exit\n"
+              << "  --record=FILE                          log landmarks, ROIs and stage timings per frame\n"
+              << "  --replay=FILE                          drive the cursor from a --record log, no camera\n"
+              << "                                         or models (--pace=fast: as fast as possible)\n"
+              << "  --cpus-STAGE=LIST                      pin a stage to CPUs (e.g. 2-3); STAGE is camera,\n"
+              << "                                         capture, palm, inference, cursor or render\n"
+              << "  --rt-priority=N                        SCHED_FIFO priority for camera, capture and\n"
+              << "                                         cursor threads (needs CAP_SYS_NICE; 0 = off)\n"
+              << "  --config=FILE|none                     settings file applied before the flags\n"
+              << "                                         (default " TUNED_CONFIG_PATH " if present)\n"
+              << "  --tune[=FILE]                          sweep backend, threads, resolution and camera\n"
+              << "                                         rate on the given source; write the best to FILE\n"
+              << "  --tune-seconds=N                       length of each tuning run\n";
+}
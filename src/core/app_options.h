@@ -0,0 +1,64 @@
+#ifndef APP_OPTIONS_H
+#define APP_OPTIONS_H
+
+#include "types.h"
+#include <string>
+#include <vector>
+
+// Runtime settings, given on the command line as --key=value (or --flag).
+struct AppOptions {
+    std::string palm_model = PALM_MODEL_PATH;
+    std::string hand_model = HAND_LANDMARK_MODEL_PATH;
+    InferenceBackend palm_backend = InferenceBackend::DEFAULT;
+    InferenceBackend hand_backend = InferenceBackend::DEFAULT;
+    bool palm_fp16 = false;
+    bool hand_fp16 = false;
+    bool palm_weighted_nms = false;
+    float palm_budget = PALM_CPU_BUDGET;
+    int palm_latency_ms = PALM_MAX_LATENCY_MS;
+    int palm_threads = PALM_NUM_THREADS;
+    int hand_threads = HAND_NUM_THREADS;
+    float hand_motion_thresh = HAND_MOTION_THRESH;
+    int hand_max_reuse = HAND_MAX_REUSE;
+
+    std::string source = "camera";   // "camera", a video file or an image directory
+    bool replay_realtime = true;     // file sources: recorded rate, or as fast as possible
+    bool replay_loop = false;
+    int source_fps = 30;             // image directories
+    int width = 800;
+    int height = 600;
+    int camera_fps = CAMERA_FPS;
+    ImageFormat pixel_format = IMAGE_NV12;
+    bool mouse = true;
+    bool headless = !ENABLE_PREVIEW;
+    int preview_fps = PREVIEW_FPS;
+    CursorFilterType cursor_filter = CursorFilterType::ONE_EURO;
+    bool cursor_predict = true;
+    int cursor_hz = CURSOR_OUTPUT_HZ;
+    std::string trace_path;          // Chrome trace JSON, written on SIGUSR1 and at exit
+    std::string record_path;         // landmark log written while running
+    std::string replay_path;         // landmark log to replay instead of running the pipeline
+
+    // CPUs per stage (empty: unpinned). The palm and inference sets also hold
+    // the interpreters' worker pools; camera covers libcamera's threads.
+    std::vector<int> cpus_camera, cpus_capture, cpus_palm, cpus_inference, cpus_cursor, cpus_render;
+    int rt_priority = 0;             // SCHED_FIFO for camera, capture and cursor (0: off)
+
+    std::string config_path;         // settings file that was applied, if any
+    std::string tune_path;           // --tune: sweep settings and write the best here
+    int tune_seconds = 6;            // per trial, the first second is not measured
+};
+
+const char *backendName(InferenceBackend b);
+bool applyOption(AppOptions &opt, const std::string &key, const std::string &value);
+// Reads key=value lines (same keys as the flags, '#' comments). A missing file
+// is an error only when required.
+bool loadOptionsFile(AppOptions &opt, const std::string &path, bool required);
+// Writes the settings --tune chooses in the format loadOptionsFile reads.
+bool saveTunedOptions(const AppOptions &opt, const std::string &path, const std::string &comment);
+// Applies TUNED_CONFIG_PATH (or --config=FILE, --config=none for nothing),
+// then the command line on top.
+bool parseOptions(int argc, char **argv, AppOptions &opt);
+void printUsage(const char *prog);
+
+#endif
@@ -0,0 +1,48 @@
+#include "buffer_pool.h"
+#include <cstdlib>
+#include <new>
+
+static const size_t kAlign = 64;
+
+BufferPool::~BufferPool() { std::free(base_); }
+
+void BufferPool::reserve(size_t block_size, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::free(base_);
+    base_ = nullptr;
+    block_size_ = (block_size + kAlign - 1) / kAlign * kAlign;
+    count_ = count;
+    free_.clear();
+    if (!block_size_ || !count_) {
+        count_ = 0;
+        return;
+    }
+    base_ = (uint8_t *)std::aligned_alloc(kAlign, block_size_ * count_);
+    if (!base_) throw std::bad_alloc();
+    free_.reserve(count_);
+    // Handed out lowest address first.
+    for (size_t i = count_; i-- > 0;) free_.push_back(base_ + i * block_size_);
+}
+
+void *BufferPool::acquire(size_t size) {
+    if (size <= block_size_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            void *p = free_.back();
+            free_.pop_back();
+            return p;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void BufferPool::release(void *p) {
+    if (!p) return;
+    if (!owns(p)) {
+        ::operator delete(p);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(p);
+}
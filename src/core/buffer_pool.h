@@ -0,0 +1,61 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed set of equal-size blocks, allocated once and recycled. acquire() and
+// release() may be called from any thread. A request larger than a block, or
+// one made while every block is out, is served by the heap and counted as a
+// miss, so an undersized pool shows up instead of failing.
+class BufferPool {
+public:
+    BufferPool() {}
+    ~BufferPool();
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // count blocks of at least block_size bytes, 64-byte aligned. Only while
+    // no block is out.
+    void reserve(size_t block_size, size_t count);
+
+    void *acquire(size_t size);
+    void release(void *p);
+
+    size_t blockSize() const { return block_size_; }
+    size_t capacity() const { return count_; }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    bool owns(const void *p) const {
+        return base_ && (const uint8_t *)p >= base_ && (const uint8_t *)p < base_ + block_size_ * count_;
+    }
+
+    uint8_t *base_ = nullptr;
+    size_t block_size_ = 0;
+    size_t count_ = 0;
+    std::mutex mutex_;
+    std::vector<void *> free_;      // capacity count_, so release never allocates
+    std::atomic<uint64_t> misses_{0};
+};
+
+// std allocator over a pool, for containers and shared_ptr control blocks.
+template<typename T>
+struct PoolAllocator {
+    typedef T value_type;
+    BufferPool *pool;
+
+    explicit PoolAllocator(BufferPool *p) : pool(p) {}
+    template<typename U> PoolAllocator(const PoolAllocator<U> &o) : pool(o.pool) {}
+
+    T *allocate(size_t n) { return (T *)pool->acquire(n * sizeof(T)); }
+    void deallocate(T *p, size_t) { pool->release(p); }
+
+    template<typename U> bool operator==(const PoolAllocator<U> &o) const { return pool == o.pool; }
+    template<typename U> bool operator!=(const PoolAllocator<U> &o) const { return pool != o.pool; }
+};
+
+#endif
@@ -1,44 +1,101 @@
 #ifndef FRAME_BUFFER_H
 #define FRAME_BUFFER_H
 
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <climits>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
+// Lock-free single-producer / single-consumer channel with latest-value
+// semantics (triple buffer). push() never blocks: a value the consumer has not
+// taken yet is replaced and counted as overwritten. pop() sleeps on a futex
+// only when nothing new has been published.
 template<typename T>
-class SafeQueue {
-private:
-    std::queue<T> q;
-    std::mutex mtx;
-    std::condition_variable cv;
-    size_t max_size;
-    std::atomic<bool> stopped;
-
+class Mailbox {
 public:
-    SafeQueue(size_t cap) : max_size(cap), stopped(false) {}
+    Mailbox() {}
+    Mailbox(const Mailbox &) = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
 
     void push(T item) {
-        std::unique_lock<std::mutex> lk(mtx);
-        if (stopped) return;
-        if (q.size() >= max_size) q.pop();
-        q.push(std::move(item));
-        cv.notify_one();
+        if (stopped_.load(std::memory_order_acquire)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slots_[back_] = std::move(item);
+        uint32_t prev = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = prev & kIndexMask;
+        published_.fetch_add(1, std::memory_order_relaxed);
+        if (prev & kFresh) {
+            // Release what the consumer never saw now, not on the next push.
+            slots_[back_] = T();
+            overwritten_.fetch_add(1, std::memory_order_relaxed);
+        }
+        signal();
     }
 
-    bool pop(T &out) {
-        std::unique_lock<std::mutex> lk(mtx);
-        cv.wait(lk, [this]{ return !q.empty() || stopped; });
-        if (stopped && q.empty()) return false;
-        out = std::move(q.front());
-        q.pop();
+    bool try_pop(T &out) {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+        uint32_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & kIndexMask;
+        out = std::move(slots_[front_]);
+        consumed_.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
+    // Blocks until a new value is available; false once stopped and drained.
+    bool pop(T &out) {
+        for (;;) {
+            uint32_t seq = seq_.load(std::memory_order_seq_cst);
+            if (try_pop(out)) return true;
+            if (stopped_.load(std::memory_order_acquire)) return false;
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            if (seq_.load(std::memory_order_seq_cst) == seq) futex(FUTEX_WAIT_PRIVATE, seq);
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
     void stop() {
-        stopped = true;
-        cv.notify_all();
+        stopped_.store(true, std::memory_order_release);
+        seq_.fetch_add(1, std::memory_order_seq_cst);
+        futex(FUTEX_WAKE_PRIVATE, INT_MAX);
+    }
+
+    bool stopped() const { return stopped_.load(std::memory_order_acquire); }
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t consumed() const { return consumed_.load(std::memory_order_relaxed); }
+    // Published values replaced before the consumer took them.
+    uint64_t overwritten() const { return overwritten_.load(std::memory_order_relaxed); }
+    // Values refused because push() came after stop(); never published.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kIndexMask = 3;
+    static constexpr uint32_t kFresh = 4;
+
+    void signal() {
+        seq_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst)) futex(FUTEX_WAKE_PRIVATE, INT_MAX);
     }
+
+    void futex(int op, uint32_t val) {
+        static_assert(sizeof(seq_) == sizeof(uint32_t), "futex word must be 32-bit");
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&seq_), op, val, nullptr, nullptr, 0);
+    }
+
+    T slots_[3];
+    alignas(64) std::atomic<uint32_t> middle_{0};
+    alignas(64) uint32_t back_ = 1;      // producer only
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> overwritten_{0};
+    std::atomic<uint64_t> dropped_{0};
+    alignas(64) uint32_t front_ = 2;     // consumer only
+    std::atomic<uint64_t> consumed_{0};
+    alignas(64) std::atomic<uint32_t> seq_{0};
+    std::atomic<uint32_t> waiters_{0};
+    std::atomic<bool> stopped_{false};
 };
 
 #endif
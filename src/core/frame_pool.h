@@ -0,0 +1,46 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include "types.h"
+#include "buffer_pool.h"
+#include <new>
+
+// Everything a captured frame needs on the heap, allocated when the source
+// starts: the Frame with its shared_ptr control block, the pyramid levels
+// and, for sources that own their pixels, the image. Sized for the most
+// frames alive at once; misses() counts what still came from the heap.
+class FramePool {
+public:
+    void reserve(int frames, int width, int height, ImageFormat format, size_t image_bytes = 0) {
+        objects_.reserve(sizeof(Frame), (size_t)frames * 2);
+        pyramids_.reserve(FramePyramid::storageBytes(width, height, format), frames);
+        images_.reserve(image_bytes, image_bytes ? frames : 0);
+    }
+
+    // A blank Frame to fill in. When the last reference goes the frame is
+    // destroyed, its memory recycled, and then done() is called (to hand the
+    // pixels back).
+    template<typename Done>
+    FramePtr make(Frame *&frame, Done done) {
+        frame = new (objects_.acquire(sizeof(Frame))) Frame;
+        frame->pyramid.pool = &pyramids_;
+        BufferPool *objects = &objects_;
+        return FramePtr(frame, [objects, done](const Frame *p) mutable {
+            p->~Frame();
+            objects->release((void *)p);
+            done();
+        }, PoolAllocator<Frame>(objects));
+    }
+
+    void *acquireImage(size_t size) { return images_.acquire(size); }
+    void releaseImage(void *p) { images_.release(p); }
+
+    uint64_t misses() const { return objects_.misses() + pyramids_.misses() + images_.misses(); }
+
+private:
+    BufferPool objects_;     // Frames and control blocks
+    BufferPool pyramids_;
+    BufferPool images_;
+};
+
+#endif
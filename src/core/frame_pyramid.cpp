@@ -0,0 +1,174 @@
+#include "frame_pyramid.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PYRAMID_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PYRAMID_SSE 1
+#endif
+
+namespace {
+
+// Full 2x2 blocks of a row pair with C interleaved channels; returns how
+// many output pixels were written.
+template<int C>
+int box_row_simd(const uint8_t *r0, const uint8_t *r1, uint8_t *out, int n) {
+    int x = 0;
+#if defined(PYRAMID_NEON)
+    // De-interleave, add horizontal pairs, add the rows, round-narrow (+2 >> 2).
+    for (; x + 8 <= n; x += 8) {
+        const uint8_t *a = r0 + 2 * x * C, *b = r1 + 2 * x * C;
+        uint8_t *o = out + x * C;
+        if constexpr (C == 1) {
+            vst1_u8(o, vrshrn_n_u16(vaddq_u16(vpaddlq_u8(vld1q_u8(a)), vpaddlq_u8(vld1q_u8(b))), 2));
+        } else if constexpr (C == 2) {
+            uint8x16x2_t va = vld2q_u8(a), vb = vld2q_u8(b);
+            uint8x8x2_t r;
+            for (int c = 0; c < 2; ++c)
+                r.val[c] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(va.val[c]), vpaddlq_u8(vb.val[c])), 2);
+            vst2_u8(o, r);
+        } else {
+            uint8x16x3_t va = vld3q_u8(a), vb = vld3q_u8(b);
+            uint8x8x3_t r;
+            for (int c = 0; c < 3; ++c)
+                r.val[c] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(va.val[c]), vpaddlq_u8(vb.val[c])), 2);
+            vst3_u8(o, r);
+        }
+    }
+#elif defined(PYRAMID_SSE)
+    if constexpr (C == 1) {
+        const __m128i lo = _mm_set1_epi16(0x00ff), two = _mm_set1_epi16(2);
+        for (; x + 8 <= n; x += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(r0 + 2 * x));
+            __m128i b = _mm_loadu_si128((const __m128i *)(r1 + 2 * x));
+            __m128i s = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, lo), _mm_srli_epi16(a, 8)),
+                                      _mm_add_epi16(_mm_and_si128(b, lo), _mm_srli_epi16(b, 8)));
+            s = _mm_srli_epi16(_mm_add_epi16(s, two), 2);
+            _mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(s, s));
+        }
+    }
+#endif
+    return x;
+}
+
+// Rounded mean of each 2x2 block of a plane with C interleaved channels. The
+// last source column/row is repeated when the source is odd-sized (chroma).
+template<int C>
+void box_down2(const uint8_t *src, size_t src_stride, int src_w, int src_h,
+               uint8_t *dst, size_t dst_stride, int dst_w, int dst_h) {
+    const int full = std::min(dst_w, src_w / 2);
+    for (int y = 0; y < dst_h; ++y) {
+        const uint8_t *r0 = src + (size_t)(2 * y) * src_stride;
+        const uint8_t *r1 = src + (size_t)std::min(2 * y + 1, src_h - 1) * src_stride;
+        uint8_t *out = dst + (size_t)y * dst_stride;
+        int x = box_row_simd<C>(r0, r1, out, full);
+        for (; x < full; ++x) {
+            for (int c = 0; c < C; ++c) {
+                const int i = 2 * x * C + c;
+                out[x * C + c] = (uint8_t)((r0[i] + r0[i + C] + r1[i] + r1[i + C] + 2) >> 2);
+            }
+        }
+        for (; x < dst_w; ++x) {
+            for (int c = 0; c < C; ++c) {
+                const int i = 2 * x * C + c;
+                out[x * C + c] = (uint8_t)((r0[i] * 2 + r1[i] * 2 + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Bytes of a level below one of w x h.
+size_t level_bytes(int &w, int &h, ImageFormat format) {
+    w = std::max(1, w / 2);
+    h = std::max(1, h / 2);
+    if (format == IMAGE_BGR888) return (size_t)w * h * 3;
+    return (size_t)w * h + (size_t)((w + 1) / 2) * ((h + 1) / 2) * 2;
+}
+
+void build_level(const image_view_t &src, uint8_t *data, image_view_t &dst) {
+    dst = image_view_t();
+    dst.format = src.format;
+    dst.width = std::max(1, src.width / 2);
+    dst.height = std::max(1, src.height / 2);
+    const int w = dst.width, h = dst.height;
+    if (src.format == IMAGE_BGR888) {
+        dst.plane[0] = data;
+        dst.stride[0] = (size_t)w * 3;
+        box_down2<3>(src.plane[0], src.stride[0], src.width, src.height, data, dst.stride[0], w, h);
+        return;
+    }
+
+    const int src_cw = (src.width + 1) / 2, src_ch = (src.height + 1) / 2;
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    uint8_t *y = data, *c = y + (size_t)w * h;
+    dst.plane[0] = y;
+    dst.stride[0] = w;
+    box_down2<1>(src.plane[0], src.stride[0], src.width, src.height, y, w, w, h);
+    if (src.format == IMAGE_NV12) {
+        dst.plane[1] = c;
+        dst.stride[1] = (size_t)cw * 2;
+        box_down2<2>(src.plane[1], src.stride[1], src_cw, src_ch, c, dst.stride[1], cw, ch);
+    } else {
+        dst.plane[1] = c;
+        dst.plane[2] = c + (size_t)cw * ch;
+        dst.stride[1] = dst.stride[2] = cw;
+        box_down2<1>(src.plane[1], src.stride[1], src_cw, src_ch, c, cw, cw, ch);
+        box_down2<1>(src.plane[2], src.stride[2], src_cw, src_ch, c + (size_t)cw * ch, cw, cw, ch);
+    }
+}
+
+}
+
+FramePyramid::~FramePyramid() {
+    if (!storage_) return;
+    if (pool) pool->release(storage_);
+    else ::operator delete(storage_);
+}
+
+size_t FramePyramid::storageBytes(int width, int height, ImageFormat format) {
+    size_t total = 0;
+    for (int k = 1; k < kLevels; ++k) total += level_bytes(width, height, format);
+    return total;
+}
+
+// Every level lives in one block, taken when the first one is built.
+const image_view_t &FramePyramid::level(const image_view_t &base, int k) const {
+    k = std::min(std::max(k, 0), kLevels - 1);
+    if (k == 0) return base;
+    Level &l = levels_[k - 1];
+    std::call_once(l.built, [&] {
+        const image_view_t &src = level(base, k - 1);
+        std::call_once(allocated_, [&] {
+            const size_t n = storageBytes(base.width, base.height, base.format);
+            storage_ = (uint8_t *)(pool ? pool->acquire(n) : ::operator new(n));
+        });
+        size_t offset = 0;
+        int w = base.width, h = base.height;
+        for (int j = 1; j < k; ++j) offset += level_bytes(w, h, base.format);
+        build_level(src, storage_ + offset, l.view);
+    });
+    return l.view;
+}
+
+int pyramidLevelFor(float scale) {
+    int k = 0;
+    while (k + 1 < FramePyramid::kLevels && scale >= (float)(2 << k)) ++k;
+    return k;
+}
+
+float affineScale(const float m[6]) {
+    return std::sqrt(std::fabs(m[0] * m[4] - m[1] * m[3]));
+}
+
+void affineToLevel(const float m[6], int k, float out[6]) {
+    const float s = 1.0f / (float)(1 << k);
+    const float o = 0.5f * s - 0.5f;
+    for (int r = 0; r < 2; ++r) {
+        out[r * 3] = m[r * 3] * s;
+        out[r * 3 + 1] = m[r * 3 + 1] * s;
+        out[r * 3 + 2] = m[r * 3 + 2] * s + o;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef FRAME_PYRAMID_H
+#define FRAME_PYRAMID_H
+
+#include "image_view.h"
+#include "buffer_pool.h"
+#include <mutex>
+
+// 2x2 box-filtered copies of a frame, built on first request and shared by
+// every stage holding the frame. Level 0 is the frame itself, level k is
+// 1/2^k of it in the same pixel format (odd last rows/columns dropped).
+// Frame pixel x maps to (x + 0.5) / 2^k - 0.5 on level k.
+class FramePyramid {
+public:
+    static constexpr int kLevels = 4;
+
+    FramePyramid() {}
+    ~FramePyramid();
+    FramePyramid(const FramePyramid &) = delete;
+    FramePyramid &operator=(const FramePyramid &) = delete;
+
+    // Thread-safe; base is the view of the frame that owns the pyramid.
+    const image_view_t &level(const image_view_t &base, int k) const;
+
+    // Bytes of all levels of a frame, taken as one block from pool when set
+    // (from the heap otherwise) on the first build.
+    static size_t storageBytes(int width, int height, ImageFormat format);
+    BufferPool *pool = nullptr;
+
+private:
+    struct Level {
+        std::once_flag built;
+        image_view_t view;
+    };
+    mutable Level levels_[kLevels - 1];
+    mutable std::once_flag allocated_;
+    mutable uint8_t *storage_ = nullptr;
+};
+
+// Level for a kernel stepping `scale` frame pixels per output pixel: the
+// coarsest one on which the step is still at least a pixel.
+int pyramidLevelFor(float scale);
+
+// Source step of a dst->frame affine map (2x3): sqrt of the area ratio.
+float affineScale(const float m[6]);
+
+// Rewrites a dst->frame affine map so it samples level k instead.
+void affineToLevel(const float m[6], int k, float out[6]);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef IMAGE_VIEW_H
+#define IMAGE_VIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum ImageFormat {
+    IMAGE_BGR888,   // packed B,G,R (libcamera RGB888)
+    IMAGE_NV12,     // Y plane, then interleaved Cb,Cr at half resolution
+    IMAGE_YUV420,   // Y, Cb and Cr planes, chroma at half resolution
+};
+
+// Non-owning description of a frame's pixel planes. YUV is full-range
+// BT.601 (libcamera ColorSpace::Sycc).
+struct image_view_t {
+    ImageFormat format = IMAGE_BGR888;
+    int width = 0, height = 0;
+    const uint8_t *plane[3] = {nullptr, nullptr, nullptr};
+    size_t stride[3] = {0, 0, 0};
+
+    bool empty() const { return !plane[0] || width <= 0 || height <= 0; }
+};
+
+inline image_view_t bgrView(const uint8_t *data, int width, int height, size_t stride) {
+    image_view_t v;
+    v.format = IMAGE_BGR888;
+    v.width = width; v.height = height;
+    v.plane[0] = data; v.stride[0] = stride;
+    return v;
+}
+
+#endif
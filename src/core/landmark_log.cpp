@@ -0,0 +1,204 @@
+#include "landmark_log.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t kGrowBytes = 4 << 20;   // ~6900 records, ~4 min at 30 fps
+
+static_assert(sizeof(landmark_log_header_t) % 8 == 0, "records must stay 8-byte aligned");
+static_assert(sizeof(landmark_log_record_t) % 8 == 0, "records must stay 8-byte aligned");
+
+int landmarkLogResults(const landmark_log_header_t &header, const landmark_log_record_t &record,
+                       hand_landmark_result_t out[MAX_HAND_NUM]) {
+    const int n = std::min<int>(record.hand_count, MAX_HAND_NUM);
+    for (int i = 0; i < n; ++i) {
+        const landmark_log_hand_t &h = record.hands[i];
+        out[i].hand_id = h.track_id;
+        out[i].score = h.score;
+        memcpy(out[i].joint, h.joint, sizeof(out[i].joint));
+        out[i].frame_width = (int)header.frame_width;
+        out[i].frame_height = (int)header.frame_height;
+    }
+    return n;
+}
+
+bool LandmarkLogWriter::open(const std::string &path, uint32_t frame_width, uint32_t frame_height) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Log Error: cannot create " << path << std::endl;
+        return false;
+    }
+    if (!reserve(kGrowBytes)) {
+        close();
+        return false;
+    }
+    landmark_log_header_t *h = (landmark_log_header_t *)map_;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, LANDMARK_LOG_MAGIC, sizeof(h->magic));
+    h->version = LANDMARK_LOG_VERSION;
+    h->header_size = sizeof(landmark_log_header_t);
+    h->record_size = sizeof(landmark_log_record_t);
+    h->max_hands = MAX_HAND_NUM;
+    h->joints = HAND_JOINT_NUM;
+    h->frame_width = frame_width;
+    h->frame_height = frame_height;
+    h->index_stride = LANDMARK_LOG_INDEX_STRIDE;
+    return true;
+}
+
+bool LandmarkLogWriter::reserve(size_t bytes) {
+    if (bytes <= mapped_) return true;
+    const size_t size = (bytes + kGrowBytes - 1) / kGrowBytes * kGrowBytes;
+    if (ftruncate(fd_, size) != 0) {
+        std::cerr << "Log Error: cannot grow the log" << std::endl;
+        return false;
+    }
+    void *m = map_ ? mremap(map_, mapped_, size, MREMAP_MAYMOVE)
+                   : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (m == MAP_FAILED) {
+        std::cerr << "Log Error: cannot map the log" << std::endl;
+        return false;
+    }
+    map_ = (uint8_t *)m;
+    mapped_ = size;
+    return true;
+}
+
+uint64_t LandmarkLogWriter::count() const {
+    return map_ ? ((const landmark_log_header_t *)map_)->record_count : 0;
+}
+
+bool LandmarkLogWriter::append(const landmark_log_record_t &record) {
+    if (!map_) return false;
+    landmark_log_header_t *h = (landmark_log_header_t *)map_;
+    const size_t end = sizeof(landmark_log_header_t) + (h->record_count + 1) * sizeof(record);
+    if (end > mapped_) {
+        if (!reserve(end)) return false;
+        h = (landmark_log_header_t *)map_;
+    }
+    memcpy(map_ + end - sizeof(record), &record, sizeof(record));
+    h->record_count++;
+    return true;
+}
+
+bool LandmarkLogWriter::close() {
+    if (fd_ < 0) return true;
+    bool ok = map_ != nullptr;
+    if (map_) {
+        landmark_log_header_t *h = (landmark_log_header_t *)map_;
+        const uint64_t n = h->record_count;
+        const size_t records_end = sizeof(landmark_log_header_t) + n * sizeof(landmark_log_record_t);
+        const uint64_t entries = (n + LANDMARK_LOG_INDEX_STRIDE - 1) / LANDMARK_LOG_INDEX_STRIDE;
+        const size_t end = records_end + entries * sizeof(landmark_log_index_t);
+        ok = reserve(end);
+        if (ok) {
+            h = (landmark_log_header_t *)map_;
+            const landmark_log_record_t *records = (const landmark_log_record_t *)(map_ + sizeof(*h));
+            landmark_log_index_t *index = (landmark_log_index_t *)(map_ + records_end);
+            for (uint64_t e = 0; e < entries; ++e) {
+                index[e].record = e * LANDMARK_LOG_INDEX_STRIDE;
+                index[e].timestamp_ns = records[index[e].record].timestamp_ns;
+            }
+            h->index_offset = entries ? records_end : 0;
+            h->index_count = entries;
+        }
+        munmap(map_, mapped_);
+        map_ = nullptr;
+        mapped_ = 0;
+        if (ok && ftruncate(fd_, end) != 0) ok = false;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (!ok) std::cerr << "Log Error: the log was not closed cleanly" << std::endl;
+    return ok;
+}
+
+bool LandmarkLogReader::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Log Error: cannot open " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(landmark_log_header_t)) {
+        std::cerr << "Log Error: " << path << " is not a landmark log" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        std::cerr << "Log Error: cannot map " << path << std::endl;
+        return false;
+    }
+    map_ = (const uint8_t *)m;
+    mapped_ = st.st_size;
+
+    const landmark_log_header_t &h = header();
+    if (memcmp(h.magic, LANDMARK_LOG_MAGIC, sizeof(h.magic)) != 0 || h.version != LANDMARK_LOG_VERSION ||
+        h.header_size != sizeof(landmark_log_header_t) || h.record_size != sizeof(landmark_log_record_t)) {
+        std::cerr << "Log Error: " << path << " has an unknown format (version or build differs)" << std::endl;
+        close();
+        return false;
+    }
+    records_ = (const landmark_log_record_t *)(map_ + h.header_size);
+    // Records past the end of the file (a writer that never closed) are cut.
+    count_ = std::min<uint64_t>(h.record_count, (mapped_ - h.header_size) / h.record_size);
+    if (h.index_offset) {
+        if (validIndex(h)) {
+            index_ = (const landmark_log_index_t *)(map_ + h.index_offset);
+            index_count_ = h.index_count;
+        } else {
+            std::cerr << "Log Warning: " << path << " has a damaged index, searching records directly" << std::endl;
+        }
+    }
+    return true;
+}
+
+// The index must lie past the records, aligned, inside the file, and point
+// at records in order; anything else and seek() would search a bad range.
+bool LandmarkLogReader::validIndex(const landmark_log_header_t &h) const {
+    const uint64_t records_end = h.header_size + count_ * h.record_size;
+    if (!h.index_stride || h.index_offset % 8 || h.index_offset < records_end || h.index_offset > mapped_ ||
+        h.index_count > (mapped_ - h.index_offset) / sizeof(landmark_log_index_t))
+        return false;
+    const landmark_log_index_t *index = (const landmark_log_index_t *)(map_ + h.index_offset);
+    for (uint64_t e = 0; e < h.index_count; ++e) {
+        if (index[e].record >= count_) return false;
+        if (e && (index[e].record < index[e - 1].record || index[e].timestamp_ns < index[e - 1].timestamp_ns))
+            return false;
+    }
+    return true;
+}
+
+void LandmarkLogReader::close() {
+    if (map_) munmap((void *)map_, mapped_);
+    map_ = nullptr;
+    mapped_ = 0;
+    records_ = nullptr;
+    count_ = 0;
+    index_ = nullptr;
+    index_count_ = 0;
+}
+
+uint64_t LandmarkLogReader::seek(uint64_t timestamp_ns) const {
+    // The index narrows the search to one stride without touching the
+    // records in between; without it, search them all.
+    uint64_t lo = 0, hi = count_;
+    if (index_count_) {
+        const landmark_log_index_t *e = std::upper_bound(index_, index_ + index_count_, timestamp_ns,
+            [](uint64_t t, const landmark_log_index_t &i) { return t < i.timestamp_ns; });
+        if (e != index_) lo = (e - 1)->record;
+        if (e != index_ + index_count_) hi = std::min(hi, e->record);
+        lo = std::min(lo, hi);
+    }
+    const landmark_log_record_t *r = std::lower_bound(records_ + lo, records_ + hi, timestamp_ns,
+        [](const landmark_log_record_t &rec, uint64_t t) { return rec.timestamp_ns < t; });
+    return r - records_;
+}
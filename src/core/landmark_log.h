@@ -0,0 +1,116 @@
+#ifndef LANDMARK_LOG_H
+#define LANDMARK_LOG_H
+
+#include "types.h"
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary log of what the tracker saw, one fixed-size record per processed
+// frame: header, records, then a sparse time index written on close. The
+// header's record count is updated on every append, so a log cut short by a
+// crash still reads back (without the index).
+
+#define LANDMARK_LOG_MAGIC "HMLMLOG1"
+#define LANDMARK_LOG_VERSION 1
+#define LANDMARK_LOG_INDEX_STRIDE 256   // records per index entry
+
+struct landmark_log_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t max_hands;         // MAX_HAND_NUM of the writer
+    uint32_t joints;            // HAND_JOINT_NUM of the writer
+    uint32_t frame_width;
+    uint32_t frame_height;
+    uint32_t index_stride;
+    uint64_t record_count;
+    uint64_t index_offset;      // 0 until closed
+    uint64_t index_count;
+};
+
+struct landmark_log_index_t {
+    uint64_t timestamp_ns;
+    uint64_t record;
+};
+
+// One landmark ROI of a frame and the model's answer for it, before tracking
+// decides which hands survive.
+struct landmark_log_hand_t {
+    int32_t track_id;
+    float score;
+    HandRoi roi;
+    fvec3 joint[HAND_JOINT_NUM];   // frame pixels
+};
+
+struct landmark_log_record_t {
+    uint64_t timestamp_ns;      // capture time
+    uint64_t sequence;
+    float palm_ms;              // 0: no palm result picked up this frame
+    float hand_ms;
+    float palm_duty;
+    int32_t primary_id;         // hand driving the cursor, -1 for none
+    uint8_t hand_count;
+    uint8_t hand_reused;        // of hand_count, answered from the landmark cache
+    uint8_t reserved[6];
+    landmark_log_hand_t hands[MAX_HAND_NUM];
+};
+
+// The hands of a record as the tracker hands them to the cursor logic
+// (hand_id is the track id); returns how many were written to out.
+int landmarkLogResults(const landmark_log_header_t &header, const landmark_log_record_t &record,
+                       hand_landmark_result_t out[MAX_HAND_NUM]);
+
+class LandmarkLogWriter {
+public:
+    LandmarkLogWriter() {}
+    ~LandmarkLogWriter() { close(); }
+    LandmarkLogWriter(const LandmarkLogWriter &) = delete;
+    LandmarkLogWriter &operator=(const LandmarkLogWriter &) = delete;
+
+    bool open(const std::string &path, uint32_t frame_width, uint32_t frame_height);
+    // Copies the record into the mapping; the file grows a chunk at a time.
+    bool append(const landmark_log_record_t &record);
+    // Writes the index and trims the file.
+    bool close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    uint64_t count() const;
+
+private:
+    bool reserve(size_t bytes);
+
+    int fd_ = -1;
+    uint8_t *map_ = nullptr;
+    size_t mapped_ = 0;
+};
+
+class LandmarkLogReader {
+public:
+    LandmarkLogReader() {}
+    ~LandmarkLogReader() { close(); }
+    LandmarkLogReader(const LandmarkLogReader &) = delete;
+    LandmarkLogReader &operator=(const LandmarkLogReader &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    const landmark_log_header_t &header() const { return *(const landmark_log_header_t *)map_; }
+    uint64_t size() const { return count_; }
+    const landmark_log_record_t &operator[](uint64_t i) const { return records_[i]; }
+    // First record captured at or after timestamp_ns (size() if none).
+    uint64_t seek(uint64_t timestamp_ns) const;
+
+private:
+    bool validIndex(const landmark_log_header_t &h) const;
+
+    const uint8_t *map_ = nullptr;
+    size_t mapped_ = 0;
+    const landmark_log_record_t *records_ = nullptr;
+    uint64_t count_ = 0;
+    const landmark_log_index_t *index_ = nullptr;
+    uint64_t index_count_ = 0;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "thread_placement.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+bool parseCpuList(const std::string &s, std::vector<int> &cpus) {
+    std::vector<int> out;
+    const char *p = s.c_str();
+    while (*p) {
+        char *end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) return false;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first || last >= CPU_SETSIZE) return false;
+            p = end;
+        }
+        for (long c = first; c <= last; ++c) out.push_back((int)c);
+        if (*p == ',') ++p;
+        else if (*p) return false;
+    }
+    if (out.empty()) return false;
+    cpus = out;
+    return true;
+}
+
+bool applyPlacement(pthread_t thread, const ThreadPlacement &p, const char *name) {
+    bool ok = true;
+    if (!p.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : p.cpus) CPU_SET(c, &set);
+        int err = pthread_setaffinity_np(thread, sizeof(set), &set);
+        if (err) {
+            std::cerr << "WARNING: cannot pin " << name << ": " << strerror(err) << "\n";
+            ok = false;
+        }
+    }
+    if (p.rt_priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = p.rt_priority;
+        int err = pthread_setschedparam(thread, SCHED_FIFO, &param);
+        if (err) {
+            std::cerr << "WARNING: cannot make " << name << " SCHED_FIFO: " << strerror(err) << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+ScopedPlacement::ScopedPlacement(const ThreadPlacement &p, const char *name) {
+    if (p.empty()) return;
+    pthread_t self = pthread_self();
+    if (pthread_getaffinity_np(self, sizeof(cpus_), &cpus_) != 0) return;
+    if (pthread_getschedparam(self, &policy_, &param_) != 0) return;
+    active_ = true;
+    applyPlacement(self, p, name);
+}
+
+ScopedPlacement::~ScopedPlacement() {
+    if (!active_) return;
+    pthread_t self = pthread_self();
+    pthread_setschedparam(self, policy_, &param_);
+    pthread_setaffinity_np(self, sizeof(cpus_), &cpus_);
+}
@@ -0,0 +1,42 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+// Where a thread runs: a set of CPUs (empty: wherever the kernel likes) and
+// an optional SCHED_FIFO priority (0: normal scheduling).
+struct ThreadPlacement {
+    std::vector<int> cpus;
+    int rt_priority = 0;
+
+    bool empty() const { return cpus.empty() && rt_priority == 0; }
+};
+
+// "0-1,3" -> {0, 1, 3}
+bool parseCpuList(const std::string &s, std::vector<int> &cpus);
+
+// Pins / prioritizes a running thread. A failure (CPU not present, no
+// CAP_SYS_NICE for SCHED_FIFO) is reported and leaves that part unchanged.
+bool applyPlacement(pthread_t thread, const ThreadPlacement &p, const char *name);
+
+// Applies a placement to the calling thread for one scope. Threads started
+// inside the scope inherit it, which is how pools created by libraries
+// (libcamera, the TFLite interpreters) are placed.
+class ScopedPlacement {
+public:
+    ScopedPlacement(const ThreadPlacement &p, const char *name);
+    ~ScopedPlacement();
+    ScopedPlacement(const ScopedPlacement &) = delete;
+    ScopedPlacement &operator=(const ScopedPlacement &) = delete;
+
+private:
+    bool active_ = false;
+    cpu_set_t cpus_;
+    int policy_ = SCHED_OTHER;
+    struct sched_param param_;
+};
+
+#endif
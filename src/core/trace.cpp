@@ -0,0 +1,147 @@
+#include "trace.h"
+#include "clock.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+std::atomic<bool> g_trace_enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+};
+
+// Relaxed atomics so a concurrent dump reads whole fields, never torn ones.
+struct TraceSlot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> begin_ns{0};
+    std::atomic<uint64_t> end_ns{0};
+};
+
+// Single writer (the owning thread). Readers copy the events and then drop
+// any slot the writer may have reused meanwhile.
+struct TraceRing {
+    TraceSlot events[TRACE_RING_EVENTS];
+    std::atomic<uint64_t> head{0};
+    int tid = 0;
+    char name[32] = "";
+};
+
+std::mutex g_rings_mutex;
+std::vector<TraceRing *> g_rings;   // never freed: dumps may outlive threads
+thread_local TraceRing *t_ring = nullptr;
+
+std::string g_trace_path;
+std::atomic<int> g_dump_requested{0};    // lock-free, so usable from the handler
+std::atomic<bool> g_watcher_running{false};
+std::thread g_watcher;
+
+TraceRing *threadRing() {
+    if (!t_ring) {
+        TraceRing *ring = new TraceRing;
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        ring->tid = (int)g_rings.size() + 1;
+        g_rings.push_back(ring);
+        t_ring = ring;
+    }
+    return t_ring;
+}
+
+void onDumpSignal(int) { g_dump_requested.store(1); }
+
+}
+
+uint64_t traceNowNs() { return monotonicNowNs(); }
+
+void traceRecord(const char *name, uint64_t begin_ns, uint64_t end_ns) {
+    TraceRing *ring = threadRing();
+    uint64_t h = ring->head.load(std::memory_order_relaxed);
+    TraceSlot &slot = ring->events[h % TRACE_RING_EVENTS];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    ring->head.store(h + 1, std::memory_order_release);
+}
+
+void traceThreadName(const char *name) {
+    if (!traceEnabled()) return;
+    TraceRing *ring = threadRing();
+    std::lock_guard<std::mutex> lock(g_rings_mutex);
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+bool traceWriteChrome(const std::string &path) {
+    std::vector<TraceRing *> rings;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        rings = g_rings;
+        for (TraceRing *ring : rings) names.push_back(ring->name[0] ? ring->name : "thread");
+    }
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    std::vector<TraceEvent> copy;
+    for (size_t r = 0; r < rings.size(); ++r) {
+        TraceRing *ring = rings[r];
+        fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                first ? "" : ",\n", ring->tid, names[r].c_str());
+        first = false;
+
+        uint64_t end = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_RING_EVENTS ? end - TRACE_RING_EVENTS : 0;
+        copy.clear();
+        for (uint64_t i = begin; i < end; ++i) {
+            const TraceSlot &slot = ring->events[i % TRACE_RING_EVENTS];
+            copy.push_back({slot.name.load(std::memory_order_relaxed), slot.begin_ns.load(std::memory_order_relaxed),
+                            slot.end_ns.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Slots below head - capacity may have been overwritten during the
+        // copy, and the one at head itself may be half-written: keep indices
+        // from now + 1 - capacity on.
+        uint64_t now = ring->head.load(std::memory_order_acquire);
+        uint64_t valid = now + 1 > TRACE_RING_EVENTS ? now + 1 - TRACE_RING_EVENTS : 0;
+        size_t skip = valid > begin ? (size_t)std::min<uint64_t>(valid - begin, copy.size()) : 0;
+
+        for (size_t i = skip; i < copy.size(); ++i) {
+            const TraceEvent &e = copy[i];
+            fprintf(f, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    e.name, ring->tid, e.begin_ns / 1e3, (e.end_ns - e.begin_ns) / 1e3);
+        }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+void traceStart(const std::string &path) {
+    g_trace_path = path;
+    g_trace_enabled.store(true);
+    std::signal(SIGUSR1, onDumpSignal);
+    g_watcher_running.store(true);
+    // Files cannot be written from a signal handler; poll the flag instead.
+    g_watcher = std::thread([] {
+        while (g_watcher_running.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            if (!g_dump_requested.exchange(0)) continue;
+            if (traceWriteChrome(g_trace_path)) fprintf(stderr, "Trace written to %s\n", g_trace_path.c_str());
+        }
+    });
+}
+
+void traceStop() {
+    if (!g_watcher_running.exchange(false)) return;
+    g_watcher.join();
+    g_trace_enabled.store(false);
+    if (traceWriteChrome(g_trace_path)) fprintf(stderr, "Trace written to %s\n", g_trace_path.c_str());
+    else fprintf(stderr, "Cannot write trace to %s\n", g_trace_path.c_str());
+}
@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "app_config.h"
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+// Stage timing spans. Each thread appends to its own fixed-size ring (no
+// locks, no allocation after the first event); the rings are merged and
+// written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) on
+// request or at exit. A span costs one relaxed load while tracing is off.
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool traceEnabled() {
+#if ENABLE_TRACING
+    return g_trace_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+uint64_t traceNowNs();   // CLOCK_MONOTONIC, same base as camera timestamps
+// name must outlive the trace (a string literal).
+void traceRecord(const char *name, uint64_t begin_ns, uint64_t end_ns);
+void traceThreadName(const char *name);
+
+bool traceWriteChrome(const std::string &path);
+// Enables tracing; SIGUSR1 then writes the trace to path, as does traceStop().
+void traceStart(const std::string &path);
+void traceStop();
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name) : _name(name), _begin(traceEnabled() ? traceNowNs() : 0) {}
+    ~TraceSpan() { if (_begin) traceRecord(_name, _begin, traceNowNs()); }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *_name;
+    uint64_t _begin;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#if ENABLE_TRACING
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(_trace_span_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) do {} while (0)
+#endif
+
+#endif
\ No newline at end of file
@@ -3,8 +3,17 @@
 
 #include <opencv2/core.hpp>
 #include <vector>
+#include <memory>
 #include <stdint.h>
 #include "app_config.h"
+#include "image_view.h"
+#include "frame_pyramid.h"
+
+// TFLite execution backend, chosen per model
+enum class InferenceBackend { DEFAULT, CPU, XNNPACK };
+
+// Smoothing applied to the cursor point
+enum class CursorFilterType { NONE, ONE_EURO, KALMAN };
 
 // Basic Math Types
 struct fvec2 { float x, y; };
@@ -15,9 +24,29 @@ struct rect_t { fvec2 topleft; fvec2 btmright; };
 struct LibcameraOutData {
     uint8_t *imageData;
     uint32_t size;
+    uint32_t stride;
+    const uint8_t *planes[3];   // Y, Cb, Cr (NV12: Cb points at the CbCr plane)
+    uint32_t strides[3];
+    uint32_t sequence;
+    uint64_t timestamp;  // ns, CLOCK_MONOTONIC
     uint64_t request;
 };
 
+// Captured frame shared by all stages without copying. The pixels belong to
+// the producer (e.g. an mmapped libcamera buffer) and are handed back when the
+// last FramePtr is released, so image must be treated as read-only.
+struct Frame {
+    cv::Mat image;      // BGR888; for YUV frames only the Y plane (CV_8UC1)
+    image_view_t view;  // all planes, what the sampling kernels read
+    bool mirrored;      // pipeline works on the horizontal mirror of image
+    uint64_t sequence;
+    uint64_t timestamp_ns; // capture time, CLOCK_MONOTONIC
+    FramePyramid pyramid;  // downscaled views, built on first use
+
+    const image_view_t &level(int k) const { return pyramid.level(view, k); }
+};
+typedef std::shared_ptr<const Frame> FramePtr;
+
 // Palm Detection Structures
 struct palm_t {
     float hand_cx, hand_cy, hand_w, hand_h; // Normalized
@@ -33,8 +62,18 @@ struct palm_detection_result_t {
     palm_t palms[MAX_PALM_NUM];
 };
 
+// Palm stage output, picked up by the tracking loop
+struct palm_candidates_t {
+    palm_detection_result_t result;
+    uint64_t frame_sequence;
+    double palm_time_ms;
+    float palm_duty;        // PalmScheduler::dutyCycle()
+    int palm_interval;      // frames between palm runs
+};
+
 // Hand Landmark Structures
 struct hand_landmark_result_t {
+    int hand_id;
     float score;
     fvec3 joint[HAND_JOINT_NUM]; // Pixel coords
     int frame_width;
@@ -48,13 +87,39 @@ struct HandRoi {
     bool isValid = false; 
 };
 
+// Cursor state published by the inference thread for the output thread.
+struct cursor_target_t {
+    bool active = false;        // a hand drives the cursor
+    float x = 0, y = 0;         // screen pixels, filtered
+    float vx = 0, vy = 0;       // screen pixels per second
+    uint64_t timestamp_ns = 0;  // capture time of the frame it was measured in
+    bool left_down = false;
+    bool right_down = false;
+};
+
 // Output Data for Renderer
 struct detection_output_t {
-    cv::Mat frame;
-    std::vector<hand_landmark_result_t> hand_results;
+    FramePtr frame;
+    uint64_t timestamp_ns;  // capture time (frame may be left out)
+    hand_landmark_result_t hand_results[MAX_HAND_NUM];  // fixed, so no per-frame allocation
+    int hand_count;
     bool is_tracking;
     double palm_time_ms;
     double hand_time_ms;
+    int hand_rois;      // ROIs sent to the landmark stage
+    int hand_reused;    // of those, answered without running the model
+    float palm_duty;
+};
+
+// End-to-end figures of one run, from the results sink.
+struct pipeline_stats_t {
+    uint64_t frames = 0;
+    double seconds = 0.0;
+    double fps = 0.0;
+    double latency_p50_ms = 0.0;   // capture to result; 0 when not measured
+    double latency_p95_ms = 0.0;
+    double hand_ms = 0.0;
+    double allocs_per_frame = 0.0; // heap allocations, whole process (ALLOC_STATS builds)
 };
 
 #endif
\ No newline at end of file
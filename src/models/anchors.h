@@ -1,11 +1,141 @@
 #ifndef ANCHORS_H
 #define ANCHORS_H
-#include <vector>
-#include "../core/types.h"
 
+// SSD anchors (MediaPipe SsdAnchorsCalculator) generated at compile time from
+// an options struct, as a structure-of-arrays table.
 
-typedef struct Anchor { float x_center, y_center, w, h; } Anchor;
+struct Anchor { float x_center, y_center, w, h; };
 
-extern std::vector<Anchor> s_anchors;
-void generate_ssd_anchors();
-#endif
\ No newline at end of file
+// Options of the 192x192 palm detection model.
+struct PalmSsdOptions {
+    static constexpr int input_size_width = 192;
+    static constexpr int input_size_height = 192;
+    static constexpr float min_scale = 0.1484375f;
+    static constexpr float max_scale = 0.75f;
+    static constexpr float anchor_offset_x = 0.5f;
+    static constexpr float anchor_offset_y = 0.5f;
+    static constexpr int num_layers = 4;
+    static constexpr int strides[num_layers] = {8, 16, 16, 16};
+    static constexpr int num_aspect_ratios = 1;
+    static constexpr float aspect_ratios[num_aspect_ratios] = {1.0f};
+    static constexpr bool reduce_boxes_in_lowest_layer = false;
+    static constexpr float interpolated_scale_aspect_ratio = 1.0f;
+    static constexpr bool fixed_anchor_size = true;
+};
+
+template<int N>
+struct AnchorTable {
+    static constexpr int count = N;
+    float x_center[N], y_center[N], w[N], h[N];
+
+    constexpr Anchor operator[](int i) const { return {x_center[i], y_center[i], w[i], h[i]}; }
+};
+
+namespace ssd_detail {
+
+constexpr float sqrt_newton(float x) {
+    if (x <= 0.0f) return 0.0f;
+    double r = x > 1.0f ? x : 1.0;
+    for (int i = 0; i < 64; ++i) r = 0.5 * (r + x / r);
+    return (float)r;
+}
+
+constexpr int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+template<typename O>
+constexpr float scale(int stride_index) {
+    if (O::num_layers == 1) return (O::min_scale + O::max_scale) * 0.5f;
+    return O::min_scale + (O::max_scale - O::min_scale) * 1.0f * stride_index / (O::num_layers - 1.0f);
+}
+
+// Anchors per feature map cell for the layers sharing the stride of `first`.
+template<typename O>
+constexpr int anchors_per_cell(int first, int last) {
+    int n = 0;
+    for (int l = first; l < last; ++l) {
+        if (l == 0 && O::reduce_boxes_in_lowest_layer) n += 3;
+        else n += O::num_aspect_ratios + (O::interpolated_scale_aspect_ratio > 0.0f ? 1 : 0);
+    }
+    return n;
+}
+
+template<typename O>
+constexpr int layer_group_end(int first) {
+    int last = first;
+    while (last < O::num_layers && O::strides[last] == O::strides[first]) ++last;
+    return last;
+}
+
+template<typename O>
+constexpr int anchor_count() {
+    int n = 0;
+    for (int first = 0; first < O::num_layers; first = layer_group_end<O>(first)) {
+        const int stride = O::strides[first];
+        n += ceil_div(O::input_size_height, stride) * ceil_div(O::input_size_width, stride) *
+             anchors_per_cell<O>(first, layer_group_end<O>(first));
+    }
+    return n;
+}
+
+template<typename O>
+constexpr AnchorTable<anchor_count<O>()> generate() {
+    constexpr int kMaxPerCell = O::num_layers * (O::num_aspect_ratios + 3);
+    AnchorTable<anchor_count<O>()> t{};
+    int k = 0;
+    for (int first = 0; first < O::num_layers; first = layer_group_end<O>(first)) {
+        const int last = layer_group_end<O>(first);
+        float widths[kMaxPerCell] = {}, heights[kMaxPerCell] = {};
+        int per_cell = 0;
+        for (int l = first; l < last; ++l) {
+            const float s = scale<O>(l);
+            if (l == 0 && O::reduce_boxes_in_lowest_layer) {
+                const float ratios[3] = {1.0f, 2.0f, 0.5f};
+                const float scales[3] = {0.1f, s, s};
+                for (int r = 0; r < 3; ++r, ++per_cell) {
+                    widths[per_cell] = scales[r] * sqrt_newton(ratios[r]);
+                    heights[per_cell] = scales[r] / sqrt_newton(ratios[r]);
+                }
+                continue;
+            }
+            for (int r = 0; r < O::num_aspect_ratios; ++r, ++per_cell) {
+                widths[per_cell] = s * sqrt_newton(O::aspect_ratios[r]);
+                heights[per_cell] = s / sqrt_newton(O::aspect_ratios[r]);
+            }
+            if (O::interpolated_scale_aspect_ratio > 0.0f) {
+                const float next = l == O::num_layers - 1 ? 1.0f : scale<O>(l + 1);
+                const float si = sqrt_newton(s * next);
+                const float ar = sqrt_newton(O::interpolated_scale_aspect_ratio);
+                widths[per_cell] = si * ar;
+                heights[per_cell] = si / ar;
+                ++per_cell;
+            }
+        }
+        const int stride = O::strides[first];
+        const int fm_h = ceil_div(O::input_size_height, stride);
+        const int fm_w = ceil_div(O::input_size_width, stride);
+        for (int y = 0; y < fm_h; ++y) {
+            for (int x = 0; x < fm_w; ++x) {
+                for (int a = 0; a < per_cell; ++a, ++k) {
+                    t.x_center[k] = (x + O::anchor_offset_x) / (float)fm_w;
+                    t.y_center[k] = (y + O::anchor_offset_y) / (float)fm_h;
+                    t.w[k] = O::fixed_anchor_size ? 1.0f : widths[a];
+                    t.h[k] = O::fixed_anchor_size ? 1.0f : heights[a];
+                }
+            }
+        }
+    }
+    return t;
+}
+
+}
+
+template<typename Options>
+struct SsdAnchors {
+    static constexpr int count = ssd_detail::anchor_count<Options>();
+    static constexpr AnchorTable<count> table = ssd_detail::generate<Options>();
+};
+
+typedef SsdAnchors<PalmSsdOptions> PalmAnchors;
+static_assert(PalmAnchors::count == 2016, "palm model expects 2016 anchors");
+
+#endif
@@ -1,6 +1,7 @@
 #include "hand_landmark.h"
+#include "preprocess.h"
+#include "../core/trace.h"
 #include <opencv2/imgproc.hpp>
-#include <tensorflow/lite/kernels/register.h>
 #include <algorithm>
 #include <iostream>
 #include <cmath>
@@ -10,21 +11,50 @@ using namespace cv;
 void HandLandmark::loadModel(const std::string &path) {
     _hand_model = tflite::FlatBufferModel::BuildFromFile(path.c_str(), &_hand_error_reporter);
     if (!_hand_model) throw std::runtime_error("Failed to load hand model");
-    tflite::ops::builtin::BuiltinOpResolver resolver;
-    tflite::InterpreterBuilder(*_hand_model.get(), resolver)(&_hand_interpreter);
-    if (!_hand_interpreter) throw std::runtime_error("Failed to create hand interpreter");
-
-    _hand_interpreter->SetNumThreads(nthreads);
-    if (_hand_interpreter->AllocateTensors() != kTfLiteOk) throw std::runtime_error("Failed to allocate hand tensors");
+    _backend_info = buildInterpreter(*_hand_model, backend, fp16, nthreads, _hand_interpreter, _hand_delegate);
 
     _hand_input = _hand_interpreter->inputs()[0];
     TfLiteIntArray *dims = _hand_interpreter->tensor(_hand_input)->dims;
     _hand_in_height = dims->data[1];
     _hand_in_width  = dims->data[2];
+    _batch = dims->data[0];
+    bindInput();
+    if (!bindOutputs()) throw std::runtime_error("Unsupported hand output tensor type");
+}
+
+void HandLandmark::bindInput() {
+    _hand_input_dst = inputTensorDst(*_hand_interpreter, _hand_input);
+}
 
-    _pHandInputLayer = _hand_interpreter->typed_tensor<float>(_hand_input);
-    _pHandOutputLayerLandmarks = _hand_interpreter->typed_tensor<float>(_hand_interpreter->outputs()[0]);
-    _pHandOutputLayerScore = _hand_interpreter->typed_tensor<float>(_hand_interpreter->outputs()[1]);
+// Quantized models are dequantized here; float outputs are used in place.
+bool HandLandmark::bindOutputs() {
+    const auto &outputs = _hand_interpreter->outputs();
+    _pHandOutputLayerLandmarks = outputAsFloat(_hand_interpreter->tensor(outputs[0]), _landmark_buf);
+    _pHandOutputLayerScore = outputAsFloat(_hand_interpreter->tensor(outputs[1]), _score_buf);
+    return _pHandOutputLayerLandmarks && _pHandOutputLayerScore;
+}
+
+// Resizes the batch dimension of the input so all ROIs go through one Invoke.
+// Models with hardcoded batch-1 reshapes refuse; those fall back to batch 1.
+bool HandLandmark::setBatch(int n) {
+    if (n == _batch) return true;
+    if (n > 1 && !_batch_supported) return false;
+    std::vector<int> shape = {n, _hand_in_height, _hand_in_width, 3};
+    if (_hand_interpreter->ResizeInputTensor(_hand_input, shape) == kTfLiteOk &&
+        _hand_interpreter->AllocateTensors() == kTfLiteOk) {
+        _batch = n;
+        bindInput();
+        return true;
+    }
+    std::cerr << "Hand model rejected batch " << n << ", running ROIs one at a time\n";
+    _batch_supported = false;
+    shape[0] = 1;
+    if (_hand_interpreter->ResizeInputTensor(_hand_input, shape) != kTfLiteOk ||
+        _hand_interpreter->AllocateTensors() != kTfLiteOk)
+        throw std::runtime_error("Failed to restore hand tensors");
+    _batch = 1;
+    bindInput();
+    return false;
 }
 
 cv::Mat getHandAffineTransform(const HandRoi &roi, int img_w, int img_h, int target_w, int target_h) {
@@ -48,37 +78,145 @@ cv::Mat getHandAffineTransform(const HandRoi &roi, int img_w, int img_h, int tar
     return cv::getAffineTransform(srcTri, dstTri);
 }
 
-void HandLandmark::run(const cv::Mat &frame_bgr, std::vector<hand_landmark_result_t> &hand_results, 
-                       const HandRoi &roi, int img_width, int img_height) {
+// Input pixel (u, v) -> ROI center + R(rotation) * (ROI size / input size) *
+// (u - target_w / 2, v - target_h / 2): the map above, inverted in closed form.
+void getHandAffineInverse(const HandRoi &roi, int img_w, int img_h, int target_w, int target_h, float inv[6]) {
+    const float c = std::cos(roi.rotation), s = std::sin(roi.rotation);
+    const float sx = roi.w * img_w / target_w, sy = roi.h * img_h / target_h;
+    const float hx = target_w * 0.5f, hy = target_h * 0.5f;
+    inv[0] = c * sx; inv[1] = -s * sy; inv[2] = roi.xc * img_w - inv[0] * hx - inv[1] * hy;
+    inv[3] = s * sx; inv[4] = c * sy;  inv[5] = roi.yc * img_h - inv[3] * hx - inv[4] * hy;
+}
+
+// Frame -> model input map (inv) and the map the sampler uses, which also
+// undoes the mirror: ROIs live in mirrored coordinates, x_raw = (w - 1) - x.
+void HandLandmark::roiSampleMap(const HandRoi &roi, const image_view_t &img, bool mirrored, int img_width, int img_height,
+                                float inv[6], float sample[6]) const {
+    getHandAffineInverse(roi, img_width, img_height, _hand_in_width, _hand_in_height, inv);
+    for (int c = 0; c < 6; ++c) sample[c] = inv[c];
+    if (mirrored) {
+        sample[0] = -inv[0]; sample[1] = -inv[1]; sample[2] = (img.width - 1) - inv[2];
+    }
+}
+
+// Samples the pyramid level matching the map's scale, so crops of large hands
+// neither alias nor read every frame pixel.
+static void warpFromPyramid(const Frame &frame, const float m[6], const tensor_dst_t &dst, int w, int h) {
+    const int k = pyramidLevelFor(affineScale(m));
+    float mk[6];
+    affineToLevel(m, k, mk);
+    warp_affine_to_rgb(frame.level(k), mk, dst, w, h);
+}
+
+// Coarse RGB thumbnail of the model input crop, sampled at the centers of
+// HAND_MOTION_THUMB^2 cells.
+void HandLandmark::thumbnail(const Frame &frame, const float sample[6], uint8_t *out) const {
+    const float sx = (float)_hand_in_width / HAND_MOTION_THUMB;
+    const float sy = (float)_hand_in_height / HAND_MOTION_THUMB;
+    const float ox = (sx - 1.0f) * 0.5f, oy = (sy - 1.0f) * 0.5f;
+    const float m[6] = {sample[0] * sx, sample[1] * sy, sample[0] * ox + sample[1] * oy + sample[2],
+                        sample[3] * sx, sample[4] * sy, sample[3] * ox + sample[4] * oy + sample[5]};
+    const tensor_dst_t dst = {out, TENSOR_U8, 1.0f / 255.0f, 0};
+    warpFromPyramid(frame, m, dst, HAND_MOTION_THUMB, HAND_MOTION_THUMB);
+}
+
+// Same hand in (nearly) the same place, and its crop has not changed since the
+// result was inferred.
+bool HandLandmark::unchanged(const LandmarkCache &c, const HandRoi &roi, const Frame &frame,
+                             int img_width, int img_height) {
+    float dx = (roi.xc - c.roi.xc) * img_width;
+    float dy = (roi.yc - c.roi.yc) * img_height;
+    float size = std::max(c.roi.w * img_width, c.roi.h * img_height);
+    if (std::sqrt(dx * dx + dy * dy) > size * 0.25f) return false;
+    if (std::fabs(roi.w - c.roi.w) > c.roi.w * 0.25f) return false;
+
+    thumbnail(frame, c.sample, _thumb);
+    int sad = 0;
+    for (int i = 0; i < kThumbBytes; ++i) sad += std::abs((int)_thumb[i] - (int)c.thumb[i]);
+    return sad < motionThreshold * kThumbBytes;
+}
+
+void HandLandmark::run(const Frame &frame, const std::vector<HandRoi> &rois,
+                       std::vector<hand_landmark_result_t> &hand_results, int img_width, int img_height) {
     hand_results.clear();
-    if (frame_bgr.empty()) return;
-
-    cv::Mat affine = getHandAffineTransform(roi, img_width, img_height, _hand_in_width, _hand_in_height);
-    cv::Mat affineInv;
-    cv::invertAffineTransform(affine, affineInv);
-
-    cv::Mat crop_bgr;
-    cv::warpAffine(frame_bgr, crop_bgr, affine, cv::Size(_hand_in_width, _hand_in_height), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0,0,0));
-    
-    cv::Mat crop_rgb;
-    cv::cvtColor(crop_bgr, crop_rgb, cv::COLOR_BGR2RGB);
-    cv::Mat inputTensorMat(_hand_in_height, _hand_in_width, CV_32FC3, _pHandInputLayer);
-    crop_rgb.convertTo(inputTensorMat, CV_32FC3, 1.0f / 255.0f);
-
-    if (_hand_interpreter->Invoke() != kTfLiteOk) return;
-
-    float score = _pHandOutputLayerScore[0];
-    if (score > 0.1f) { 
-        hand_landmark_result_t res;
-        res.score = score;
-        res.frame_width = img_width; res.frame_height = img_height;
-        for (int j = 0; j < HAND_JOINT_NUM; ++j) {
-            float x_out = _pHandOutputLayerLandmarks[3 * j + 0];
-            float y_out = _pHandOutputLayerLandmarks[3 * j + 1];
-            double x_orig = affineInv.at<double>(0, 0) * x_out + affineInv.at<double>(0, 1) * y_out + affineInv.at<double>(0, 2);
-            double y_orig = affineInv.at<double>(1, 0) * x_out + affineInv.at<double>(1, 1) * y_out + affineInv.at<double>(1, 2);
-            res.joint[j].x = (float)x_orig; res.joint[j].y = (float)y_orig; res.joint[j].z = 0; 
+    _reused = 0;
+    const image_view_t &img = frame.view;
+    if (img.empty() || rois.empty()) return;
+
+    const int n = (int)rois.size();
+    _affine_inv.resize(n);
+    _cache.resize(n);
+    hand_results.resize(n);
+
+    const bool gate = motionThreshold > 0.0f;
+    _pending.clear();
+    for (int i = 0; i < n; ++i) {
+        LandmarkCache &c = _cache[i];
+        if (gate && c.valid && c.reuses < maxReuse && unchanged(c, rois[i], frame, img_width, img_height)) {
+            hand_results[i] = c.result;
+            c.reuses++;
+            _reused++;
+            continue;
+        }
+        c.valid = false;
+        _pending.push_back(i);
+    }
+    if (_pending.empty()) return;
+
+    // The batch follows the ROI count, not the cache misses: the gate changes
+    // the miss count every few frames, and each resize re-prepares the
+    // delegate. Slots past the pending ROIs keep stale crops; their outputs
+    // are ignored.
+    const int m = (int)_pending.size();
+    const int batch = setBatch(n) ? n : 1;
+    const size_t in_stride = (size_t)_hand_in_width * _hand_in_height * 3;
+    const int num_landmarks = 3 * HAND_JOINT_NUM;
+
+    for (int first = 0; first < m; first += batch) {
+        if (batch == 1) setBatch(1);
+        const int used = std::min(batch, m - first);
+        uint64_t t0 = traceEnabled() ? traceNowNs() : 0;
+        for (int k = 0; k < used; ++k) {
+            const int i = _pending[first + k];
+            LandmarkCache &c = _cache[i];
+            roiSampleMap(rois[i], img, frame.mirrored, img_width, img_height, _affine_inv[i].data(), c.sample);
+            warpFromPyramid(frame, c.sample, _hand_input_dst.offset(k * in_stride), _hand_in_width, _hand_in_height);
+            if (gate) {
+                c.roi = rois[i];
+                thumbnail(frame, c.sample, c.thumb);
+            }
+        }
+
+        uint64_t t1 = t0 ? traceNowNs() : 0;
+        bool ok = _hand_interpreter->Invoke() == kTfLiteOk;
+        uint64_t t2 = t0 ? traceNowNs() : 0;
+        ok = ok && bindOutputs();
+        for (int k = 0; k < used; ++k) {
+            const int i = _pending[first + k];
+            hand_landmark_result_t &res = hand_results[i];
+            const float *inv = _affine_inv[i].data();
+            const float *lm = _pHandOutputLayerLandmarks + k * num_landmarks;
+            res.score = ok ? _pHandOutputLayerScore[k] : 0.0f;
+            res.hand_id = -1;
+            res.frame_width = img_width; res.frame_height = img_height;
+            for (int j = 0; j < HAND_JOINT_NUM; ++j) {
+                float x_out = ok ? lm[3 * j + 0] : 0.0f;
+                float y_out = ok ? lm[3 * j + 1] : 0.0f;
+                res.joint[j].x = inv[0] * x_out + inv[1] * y_out + inv[2];
+                res.joint[j].y = inv[3] * x_out + inv[4] * y_out + inv[5];
+                res.joint[j].z = 0;
+            }
+            if (gate && ok) {
+                LandmarkCache &c = _cache[i];
+                c.result = res;
+                c.reuses = 0;
+                c.valid = true;
+            }
+        }
+        if (t0) {
+            traceRecord("hand.preprocess", t0, t1);
+            traceRecord("hand.invoke", t1, t2);
+            traceRecord("hand.postprocess", t2, traceNowNs());
         }
-        hand_results.push_back(res);
     }
-}
\ No newline at end of file
+}
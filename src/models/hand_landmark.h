@@ -2,33 +2,81 @@
 #define HAND_LANDMARK_H
 
 #include "../core/types.h"
+#include "tflite_backend.h"
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/model.h>
 #include <tensorflow/lite/stderr_reporter.h>
 
+cv::Mat getHandAffineTransform(const HandRoi &roi, int img_w, int img_h, int target_w, int target_h);
+// Inverse of the above (model input -> frame pixels), without cv::Mat.
+void getHandAffineInverse(const HandRoi &roi, int img_w, int img_h, int target_w, int target_h, float inv[6]);
+
 class HandLandmark {
 public:
     HandLandmark() {}
     void loadModel(const std::string &model_path);
-    void run(const cv::Mat &frame_bgr, 
-             std::vector<hand_landmark_result_t> &hand_results, 
-             const HandRoi &roi, 
+    // One result per ROI, in order; all ROIs share a single batched Invoke.
+    void run(const Frame &frame,
+             const std::vector<HandRoi> &rois,
+             std::vector<hand_landmark_result_t> &hand_results,
              int img_width, int img_height);
+    const std::string &backendInfo() const { return _backend_info; }
     float confThreshold = 0.5f;
-    int nthreads = 3;
+    int nthreads = HAND_NUM_THREADS;
+    InferenceBackend backend = InferenceBackend::DEFAULT;
+    bool fp16 = false;
+    // An ROI whose crop differs from the one last inferred for it by less than
+    // motionThreshold (mean absolute difference, 0 disables) reuses that
+    // result, at most maxReuse times in a row. The Invoke is skipped only
+    // when every ROI is reused; the batch always holds one slot per ROI.
+    float motionThreshold = HAND_MOTION_THRESH;
+    int maxReuse = HAND_MAX_REUSE;
+    // ROIs answered from the cache by the last run().
+    int reusedCount() const { return _reused; }
 
 private:
+    static constexpr int kThumbBytes = HAND_MOTION_THUMB * HAND_MOTION_THUMB * 3;
+    struct LandmarkCache {
+        HandRoi roi;
+        float sample[6];               // frame map the thumbnail was taken with
+        uint8_t thumb[kThumbBytes];
+        hand_landmark_result_t result;
+        int reuses = 0;
+        bool valid = false;
+    };
+
+    friend struct BenchAccess;
     std::unique_ptr<tflite::FlatBufferModel> _hand_model;
+    TfLiteDelegatePtr _hand_delegate;
     std::unique_ptr<tflite::Interpreter> _hand_interpreter;
     tflite::StderrReporter _hand_error_reporter;
+    std::string _backend_info;
     int _hand_input = -1;
-    float *_pHandInputLayer = nullptr;
-    float *_pHandOutputLayerLandmarks = nullptr;
-    float *_pHandOutputLayerScore = nullptr;
+    tensor_dst_t _hand_input_dst;
+    const float *_pHandOutputLayerLandmarks = nullptr;
+    const float *_pHandOutputLayerScore = nullptr;
+    std::vector<float> _landmark_buf;
+    std::vector<float> _score_buf;
     int _hand_in_width = 224;
     int _hand_in_height = 224;
+    int _batch = 1;
+    bool _batch_supported = true;
+    std::vector<std::array<float, 6>> _affine_inv;
+    std::vector<LandmarkCache> _cache;   // one per ROI slot
+    std::vector<int> _pending;           // ROIs that need the model this run
+    uint8_t _thumb[kThumbBytes];
+    int _reused = 0;
+
+    void bindInput();
+    bool bindOutputs();
+    bool setBatch(int n);
+    void roiSampleMap(const HandRoi &roi, const image_view_t &img, bool mirrored, int img_width, int img_height,
+                      float inv[6], float sample[6]) const;
+    void thumbnail(const Frame &frame, const float sample[6], uint8_t *out) const;
+    bool unchanged(const LandmarkCache &c, const HandRoi &roi, const Frame &frame, int img_width, int img_height);
 };
 #endif
\ No newline at end of file
@@ -1,78 +1,147 @@
 #include "palm.h"
-#include <opencv2/imgproc.hpp>
-#include <tensorflow/lite/kernels/register.h>
 #include <cmath>
 #include <cstring>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include "../core/trace.h"
 
-PALM::PALM() {}
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PALM_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PALM_SSE 1
+#endif
+
+namespace {
+
+// sigmoid(x) > t  <=>  x > log(t / (1 - t)), so scores need no exp to be rejected.
+float logit_threshold(float score_thresh) {
+    if (score_thresh <= 0.0f) return -std::numeric_limits<float>::infinity();
+    if (score_thresh >= 1.0f) return std::numeric_limits<float>::infinity();
+    return std::log(score_thresh / (1.0f - score_thresh));
+}
+
+// Writes the indices of logits above thresh to idx (ascending); returns the count.
+// Blocks of 16 with no survivor, the common case, cost one compare per 4 lanes.
+template<int n>
+int select_above(const float *logits, float thresh, int *idx) {
+    int count = 0, i = 0;
+#if defined(PALM_NEON)
+    const float32x4_t t = vdupq_n_f32(thresh);
+    for (; i + 16 <= n; i += 16) {
+        uint32x4_t m = vorrq_u32(vorrq_u32(vcgtq_f32(vld1q_f32(logits + i), t), vcgtq_f32(vld1q_f32(logits + i + 4), t)),
+                                 vorrq_u32(vcgtq_f32(vld1q_f32(logits + i + 8), t), vcgtq_f32(vld1q_f32(logits + i + 12), t)));
+        uint32x2_t m2 = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        if (!(vget_lane_u32(m2, 0) | vget_lane_u32(m2, 1))) continue;
+        for (int k = i; k < i + 16; ++k) if (logits[k] > thresh) idx[count++] = k;
+    }
+#elif defined(PALM_SSE)
+    const __m128 t = _mm_set1_ps(thresh);
+    for (; i + 16 <= n; i += 16) {
+        unsigned mask = (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(logits + i), t))
+                      | (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(logits + i + 4), t)) << 4
+                      | (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(logits + i + 8), t)) << 8
+                      | (unsigned)_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(logits + i + 12), t)) << 12;
+        while (mask) {
+            idx[count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) if (logits[i] > thresh) idx[count++] = i;
+    return count;
+}
+
+}
+
+PALM::PALM() : _survivors(PalmAnchors::count), _candidates(PalmAnchors::count) {}
 
 void PALM::loadModel(const std::string &palm_model_path) {
     _palm_model = tflite::FlatBufferModel::BuildFromFile(palm_model_path.c_str(), &_palm_error_reporter);
     if (!_palm_model) throw std::runtime_error("Failed to load palm model");
 
-    tflite::ops::builtin::BuiltinOpResolver resolver;
-    tflite::InterpreterBuilder(*_palm_model.get(), resolver)(&_palm_interpreter);
-    if (!_palm_interpreter) throw std::runtime_error("Failed to create palm interpreter");
-    _palm_interpreter->SetNumThreads(nthreads);
-    if (_palm_interpreter->AllocateTensors() != kTfLiteOk) throw std::runtime_error("Failed to allocate palm tensors");
+    _backend_info = buildInterpreter(*_palm_model, backend, fp16, nthreads, _palm_interpreter, _palm_delegate);
 
     _palm_input = _palm_interpreter->inputs()[0];
     TfLiteIntArray *dims = _palm_interpreter->tensor(_palm_input)->dims;
     _palm_in_height = dims->data[1];
     _palm_in_width  = dims->data[2];
 
-    _pPalmInputLayer = _palm_interpreter->typed_tensor<float>(_palm_input);
-    _pPalmOutputLayerBbox = _palm_interpreter->typed_tensor<float>(_palm_interpreter->outputs()[0]);
-    _pPalmOutputLayerProb = _palm_interpreter->typed_tensor<float>(_palm_interpreter->outputs()[1]);
+    _palm_input_dst = inputTensorDst(*_palm_interpreter, _palm_input);
+    if (!bindOutputs()) throw std::runtime_error("Unsupported palm output tensor type");
 
-    generate_ssd_anchors();
+    const TfLiteIntArray *prob_dims = _palm_interpreter->tensor(_palm_interpreter->outputs()[1])->dims;
+    int prob_count = 1;
+    for (int i = 0; i < prob_dims->size; ++i) prob_count *= prob_dims->data[i];
+    if (prob_count != PalmAnchors::count) throw std::runtime_error("Palm model does not match the SSD anchor table");
 }
 
-void PALM::run(const cv::Mat &normalizedImg, palm_detection_result_t &palm_result) {
+void PALM::run(const Frame &frame, palm_detection_result_t &palm_result) {
     palm_result.num = 0;
-    if (normalizedImg.empty()) return;
-    cv::Mat palmInputMat(_palm_in_height, _palm_in_width, CV_32FC3, (void*)_pPalmInputLayer);
-    cv::resize(normalizedImg, palmInputMat, cv::Size(_palm_in_width, _palm_in_height));
-
-    if (_palm_interpreter->Invoke() != kTfLiteOk) return;
+    if (frame.view.empty()) return;
+    {
+        TRACE_SPAN("palm.preprocess");
+        // The frame is several times the input size: resample a pyramid level
+        // (shared with the landmark stage) instead of skipping source pixels.
+        const float scale = std::min((float)frame.view.width / _palm_in_width,
+                                     (float)frame.view.height / _palm_in_height);
+        resize_to_rgb(frame.level(pyramidLevelFor(scale)), frame.mirrored,
+                      _palm_input_dst, _palm_in_width, _palm_in_height);
+    }
+    {
+        TRACE_SPAN("palm.invoke");
+        if (_palm_interpreter->Invoke() != kTfLiteOk) return;
+    }
+    TRACE_SPAN("palm.postprocess");
+    if (!bindOutputs()) return;
+    postprocess(palm_result);
+}
 
-    std::list<palm_t> candidates;
-    decode_keypoints(candidates, confThreshold);
-    std::list<palm_t> final_list;
-    non_max_suppression(candidates, final_list, nmsThreshold);
-    pack_palm_result(&palm_result, final_list);
+// Decode, NMS and packing all work in _candidates; nothing is allocated.
+int PALM::postprocess(palm_detection_result_t &palm_result) {
+    int n = decode_keypoints(confThreshold);
+    n = non_max_suppression(_candidates.data(), n, nmsThreshold, weightedNms);
+    pack_palm_result(&palm_result, _candidates.data(), n);
+    return palm_result.num;
 }
 
 
-int PALM::decode_keypoints(std::list<palm_t> &palm_list, float score_thresh) {
-    int i = 0;
-    for (const auto& anchor : s_anchors) {
-        float score0 = _pPalmOutputLayerProb[i];
-        float score = 1.0f / (1.0f + std::exp(-score0));
-        if (score > score_thresh) {
-            float *p = _pPalmOutputLayerBbox + (i * 18);
-            float sx = p[0], sy = p[1], w = p[2], h = p[3];
-            float cx = sx + anchor.x_center * _palm_in_width;
-            float cy = sy + anchor.y_center * _palm_in_height;
-            cx /= (float)_palm_in_width; cy /= (float)_palm_in_height;
-            w /= (float)_palm_in_width; h /= (float)_palm_in_height;
-            palm_t item; item.score = score;
-            item.rect.topleft.x = cx - w * 0.5f; item.rect.topleft.y = cy - h * 0.5f;
-            item.rect.btmright.x = cx + w * 0.5f; item.rect.btmright.y = cy + h * 0.5f;
-            for (int j = 0; j < 7; ++j) {
-                float lx = p[4 + 2*j], ly = p[4 + 2*j + 1];
-                lx += anchor.x_center * _palm_in_width; ly += anchor.y_center * _palm_in_height;
-                item.keys[j].x = lx / (float)_palm_in_width; item.keys[j].y = ly / (float)_palm_in_height;
-            }
-            palm_list.push_back(item);
+// Quantized models are dequantized here; float outputs are used in place.
+bool PALM::bindOutputs() {
+    const auto &outputs = _palm_interpreter->outputs();
+    _pPalmOutputLayerBbox = outputAsFloat(_palm_interpreter->tensor(outputs[0]), _bbox_buf);
+    _pPalmOutputLayerProb = outputAsFloat(_palm_interpreter->tensor(outputs[1]), _prob_buf);
+    return _pPalmOutputLayerBbox && _pPalmOutputLayerProb;
+}
+
+// Thresholds the raw logits, then decodes boxes and keypoints for the
+// survivors only; the cost follows the number of detections.
+int PALM::decode_keypoints(float score_thresh) {
+    // Anchor w/h are fixed (1.0) for this model, so only the centers are read.
+    const AnchorTable<PalmAnchors::count> &anchors = PalmAnchors::table;
+    const int count = select_above<PalmAnchors::count>(_pPalmOutputLayerProb, logit_threshold(score_thresh),
+                                                       _survivors.data());
+    const float sx = 1.0f / (float)_palm_in_width, sy = 1.0f / (float)_palm_in_height;
+    for (int s = 0; s < count; ++s) {
+        const int i = _survivors[s];
+        const float ax = anchors.x_center[i], ay = anchors.y_center[i];
+        const float *p = _pPalmOutputLayerBbox + (i * 18);
+        float cx = p[0] * sx + ax, cy = p[1] * sy + ay;
+        float w = p[2] * sx, h = p[3] * sy;
+        palm_t &item = _candidates[s];
+        item.score = 1.0f / (1.0f + std::exp(-_pPalmOutputLayerProb[i]));
+        item.rect.topleft.x = cx - w * 0.5f; item.rect.topleft.y = cy - h * 0.5f;
+        item.rect.btmright.x = cx + w * 0.5f; item.rect.btmright.y = cy + h * 0.5f;
+        for (int j = 0; j < 7; ++j) {
+            item.keys[j].x = p[4 + 2*j] * sx + ax;
+            item.keys[j].y = p[4 + 2*j + 1] * sy + ay;
         }
-        ++i;
     }
-    return 0;
+    return count;
 }
-float PALM::calc_intersection_over_union(rect_t &r0, rect_t &r1) {
+float PALM::calc_intersection_over_union(const rect_t &r0, const rect_t &r1) {
     float xmin0 = std::min(r0.topleft.x, r0.btmright.x); float ymin0 = std::min(r0.topleft.y, r0.btmright.y);
     float xmax0 = std::max(r0.topleft.x, r0.btmright.x); float ymax0 = std::max(r0.topleft.y, r0.btmright.y);
     float xmin1 = std::min(r1.topleft.x, r1.btmright.x); float ymin1 = std::min(r1.topleft.y, r1.btmright.y);
@@ -85,17 +154,45 @@ float PALM::calc_intersection_over_union(rect_t &r0, rect_t &r1) {
     float iarea = ix * iy;
     return iarea / (area0 + area1 - iarea);
 }
-bool PALM::compare_score(palm_t &a, palm_t &b) { return a.score > b.score; }
-int PALM::non_max_suppression(std::list<palm_t> &in, std::list<palm_t> &out, float iou_thresh) {
-    in.sort(compare_score);
-    for (auto &cand : in) {
-        bool ignore = false;
-        for (auto &sel : out) {
-            if (calc_intersection_over_union(cand.rect, sel.rect) >= iou_thresh) { ignore = true; break; }
+// Greedy NMS in place: the best remaining candidate is swapped to the front
+// (a partial selection sort, stopping after MAX_PALM_NUM picks) and the ones
+// overlapping it are swapped out of the live range. In weighted mode the
+// picked box and keypoints become the score-weighted mean of its cluster.
+// Returns the number of picks, which are left in cands[0, n).
+int PALM::non_max_suppression(palm_t *cands, int n, float iou_thresh, bool weighted) {
+    int kept = 0;
+    while (kept < n && kept < MAX_PALM_NUM) {
+        int best = kept;
+        for (int i = kept + 1; i < n; ++i) if (cands[i].score > cands[best].score) best = i;
+        std::swap(cands[kept], cands[best]);
+        palm_t &top = cands[kept];
+
+        float wsum = top.score;
+        rect_t rect = {{top.rect.topleft.x * wsum, top.rect.topleft.y * wsum},
+                       {top.rect.btmright.x * wsum, top.rect.btmright.y * wsum}};
+        fvec2 keys[7];
+        for (int j = 0; j < 7; ++j) keys[j] = {top.keys[j].x * wsum, top.keys[j].y * wsum};
+
+        for (int i = kept + 1; i < n;) {
+            if (calc_intersection_over_union(top.rect, cands[i].rect) < iou_thresh) { ++i; continue; }
+            if (weighted) {
+                const palm_t &c = cands[i];
+                wsum += c.score;
+                rect.topleft.x += c.rect.topleft.x * c.score; rect.topleft.y += c.rect.topleft.y * c.score;
+                rect.btmright.x += c.rect.btmright.x * c.score; rect.btmright.y += c.rect.btmright.y * c.score;
+                for (int j = 0; j < 7; ++j) { keys[j].x += c.keys[j].x * c.score; keys[j].y += c.keys[j].y * c.score; }
+            }
+            cands[i] = cands[--n];
+        }
+        if (weighted && wsum > top.score) {
+            const float inv = 1.0f / wsum;
+            top.rect.topleft.x = rect.topleft.x * inv; top.rect.topleft.y = rect.topleft.y * inv;
+            top.rect.btmright.x = rect.btmright.x * inv; top.rect.btmright.y = rect.btmright.y * inv;
+            for (int j = 0; j < 7; ++j) top.keys[j] = {keys[j].x * inv, keys[j].y * inv};
         }
-        if (!ignore) { out.push_back(cand); if (out.size() >= MAX_PALM_NUM) break; }
+        ++kept;
     }
-    return 0;
+    return kept;
 }
 float PALM::normalize_radians(float angle) { return angle - 2 * M_PI * std::floor((angle - (-M_PI)) / (2 * M_PI)); }
 void PALM::rot_vec(fvec2 &vec, float rotation) {
@@ -127,11 +224,11 @@ void PALM::compute_hand_rect(palm_t &palm) {
         palm.hand_pos[i].x = v.x + palm.hand_cx; palm.hand_pos[i].y = v.y + palm.hand_cy;
     }
 }
-void PALM::pack_palm_result(palm_detection_result_t *res, std::list<palm_t> &list) {
-    int n = 0;
-    for (auto &p : list) {
-        compute_rotation(p); compute_hand_rect(p);
-        if (n < MAX_PALM_NUM) res->palms[n++] = p;
+void PALM::pack_palm_result(palm_detection_result_t *res, palm_t *palms, int n) {
+    if (n > MAX_PALM_NUM) n = MAX_PALM_NUM;
+    for (int i = 0; i < n; ++i) {
+        compute_rotation(palms[i]); compute_hand_rect(palms[i]);
+        res->palms[i] = palms[i];
     }
     res->num = n;
 }
\ No newline at end of file
@@ -1,11 +1,11 @@
 #ifndef PALM_H
 #define PALM_H
 
-#include <list>
 #include <string>
 #include <memory>
 #include "../core/types.h"
 #include "anchors.h"
+#include "tflite_backend.h"
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/model.h>
 #include <tensorflow/lite/stderr_reporter.h>
@@ -14,31 +14,44 @@ class PALM {
 public:
     PALM();
     void loadModel(const std::string &palm_model_path);
-    void run(const cv::Mat &normalizedImg, palm_detection_result_t &palm_result);
+    void run(const Frame &frame, palm_detection_result_t &palm_result);
+    const std::string &backendInfo() const { return _backend_info; }
 
     float confThreshold = 0.5f;
     float nmsThreshold = 0.3f;
-    int nthreads = 2;
+    // Blend overlapping boxes by score (MediaPipe WEIGHTED) instead of dropping them.
+    bool weightedNms = false;
+    int nthreads = PALM_NUM_THREADS;
+    InferenceBackend backend = InferenceBackend::DEFAULT;
+    bool fp16 = false;
 
 private:
+    friend struct BenchAccess;
     std::unique_ptr<tflite::FlatBufferModel> _palm_model;
+    TfLiteDelegatePtr _palm_delegate;
     std::unique_ptr<tflite::Interpreter> _palm_interpreter;
     tflite::StderrReporter _palm_error_reporter;
+    std::string _backend_info;
     int _palm_input = -1;
-    float *_pPalmInputLayer = nullptr;
-    float *_pPalmOutputLayerBbox = nullptr;
-    float *_pPalmOutputLayerProb = nullptr;
+    tensor_dst_t _palm_input_dst;
+    const float *_pPalmOutputLayerBbox = nullptr;
+    const float *_pPalmOutputLayerProb = nullptr;
+    std::vector<float> _bbox_buf;
+    std::vector<float> _prob_buf;
+    std::vector<int> _survivors;
+    std::vector<palm_t> _candidates; // one slot per anchor, allocated once
     int _palm_in_width = 192;
     int _palm_in_height = 192;
 
-    int decode_keypoints(std::list<palm_t> &palm_list, float score_thresh);
-    float calc_intersection_over_union(rect_t &rect0, rect_t &rect1);
-    static bool compare_score(palm_t &a, palm_t &b);
-    int non_max_suppression(std::list<palm_t> &in, std::list<palm_t> &out, float iou_thresh);
+    bool bindOutputs();
+    int postprocess(palm_detection_result_t &palm_result);
+    int decode_keypoints(float score_thresh);
+    float calc_intersection_over_union(const rect_t &rect0, const rect_t &rect1);
+    int non_max_suppression(palm_t *cands, int n, float iou_thresh, bool weighted);
     float normalize_radians(float angle);
     void rot_vec(fvec2 &vec, float rotation);
     void compute_rotation(palm_t &palm);
     void compute_hand_rect(palm_t &palm);
-    void pack_palm_result(palm_detection_result_t *palm_result, std::list<palm_t> &palm_list);
+    void pack_palm_result(palm_detection_result_t *palm_result, palm_t *palms, int n);
 };
 #endif
\ No newline at end of file
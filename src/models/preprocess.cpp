@@ -0,0 +1,383 @@
+#include "preprocess.h"
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PREPROCESS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PREPROCESS_SSE 1
+#endif
+
+namespace {
+
+// Pixel value p (0..255) is stored as p * gain + bias.
+struct Affine8 { float gain, bias; };
+
+Affine8 output_mapping(const tensor_dst_t &dst) {
+    if (dst.type == TENSOR_F32) return {1.0f / 255.0f, 0.0f};
+    return {1.0f / (255.0f * dst.scale), (float)dst.zero_point};
+}
+
+inline void put(float *o, float v) { *o = v; }
+inline void put(uint8_t *o, float v) { long q = std::lrint(v); *o = (uint8_t)(q < 0 ? 0 : q > 255 ? 255 : q); }
+inline void put(int8_t *o, float v) { long q = std::lrint(v); *o = (int8_t)(q < -128 ? -128 : q > 127 ? 127 : q); }
+
+// Rounds a float row (bias not yet applied) into an 8-bit tensor row.
+template<typename T>
+void quantize_row(const float *src, T *dst, int n, float bias) {
+    int i = 0;
+#if defined(PREPROCESS_NEON) && defined(__aarch64__)
+    const float32x4_t b = vdupq_n_f32(bias);
+    for (; i + 8 <= n; i += 8) {
+        int32x4_t q0 = vcvtnq_s32_f32(vaddq_f32(vld1q_f32(src + i), b));
+        int32x4_t q1 = vcvtnq_s32_f32(vaddq_f32(vld1q_f32(src + i + 4), b));
+        int16x8_t q = vcombine_s16(vqmovn_s32(q0), vqmovn_s32(q1));
+        if constexpr (std::is_unsigned<T>::value) vst1_u8((uint8_t *)(dst + i), vqmovun_s16(q));
+        else vst1_s8((int8_t *)(dst + i), vqmovn_s16(q));
+    }
+#elif defined(PREPROCESS_SSE)
+    const __m128 b = _mm_set1_ps(bias);
+    for (; i + 16 <= n; i += 16) {
+        __m128i q0 = _mm_cvtps_epi32(_mm_add_ps(_mm_loadu_ps(src + i), b));
+        __m128i q1 = _mm_cvtps_epi32(_mm_add_ps(_mm_loadu_ps(src + i + 4), b));
+        __m128i q2 = _mm_cvtps_epi32(_mm_add_ps(_mm_loadu_ps(src + i + 8), b));
+        __m128i q3 = _mm_cvtps_epi32(_mm_add_ps(_mm_loadu_ps(src + i + 12), b));
+        __m128i lo = _mm_packs_epi32(q0, q1), hi = _mm_packs_epi32(q2, q3);
+        __m128i q = std::is_unsigned<T>::value ? _mm_packus_epi16(lo, hi) : _mm_packs_epi16(lo, hi);
+        _mm_storeu_si128((__m128i *)(dst + i), q);
+    }
+#endif
+    for (; i < n; ++i) put(dst + i, src[i] + bias);
+}
+
+// Source pixel readers. rgb() returns pixel (x, y) as R,G,B in 0..255;
+// bilinear() blends the 2x2 block at (x0, y0) with the given weights. Both
+// require in-frame coordinates. YUV is converted per source pixel, before
+// interpolation, exactly as a full-frame color conversion would.
+struct BgrReader {
+    const uint8_t *base;
+    size_t stride;
+    explicit BgrReader(const image_view_t &v) : base(v.plane[0]), stride(v.stride[0]) {}
+
+    void rgb(int x, int y, float *out) const {
+        const uint8_t *p = base + y * stride + x * 3;
+        out[0] = p[2]; out[1] = p[1]; out[2] = p[0];
+    }
+    void bilinear(int x0, int y0, float w00, float w01, float w10, float w11, float *out) const {
+        const uint8_t *p0 = base + y0 * stride + x0 * 3;
+        const uint8_t *p1 = p0 + stride;
+        out[0] = p0[2] * w00 + p0[5] * w01 + p1[2] * w10 + p1[5] * w11;
+        out[1] = p0[1] * w00 + p0[4] * w01 + p1[1] * w10 + p1[4] * w11;
+        out[2] = p0[0] * w00 + p0[3] * w01 + p1[0] * w10 + p1[3] * w11;
+    }
+};
+
+// Full-range BT.601 in integers: per-chroma contributions from tables, then
+// a clamp. Results are whole numbers, as from a uint8 color conversion.
+struct YuvTables {
+    int16_t rv[256], gu[256], gv[256], bu[256];
+    YuvTables() {
+        for (int i = 0; i < 256; ++i) {
+            rv[i] = (int16_t)std::lrint(1.402f * (i - 128));
+            gu[i] = (int16_t)std::lrint(-0.344136f * (i - 128));
+            gv[i] = (int16_t)std::lrint(-0.714136f * (i - 128));
+            bu[i] = (int16_t)std::lrint(1.772f * (i - 128));
+        }
+    }
+};
+const YuvTables g_yuv;
+
+inline int clamp255(int v) { return v < 0 ? 0 : v > 255 ? 255 : v; }
+
+inline void yuv_to_rgb(int y, int cb, int cr, float *out) {
+    out[0] = (float)clamp255(y + g_yuv.rv[cr]);
+    out[1] = (float)clamp255(y + g_yuv.gu[cb] + g_yuv.gv[cr]);
+    out[2] = (float)clamp255(y + g_yuv.bu[cb]);
+}
+
+template<typename Derived>
+struct YuvReaderBase {
+    void bilinear(int x0, int y0, float w00, float w01, float w10, float w11, float *out) const {
+        const Derived &d = static_cast<const Derived &>(*this);
+        float a[3], b[3], c[3], e[3];
+        d.rgb(x0, y0, a); d.rgb(x0 + 1, y0, b);
+        d.rgb(x0, y0 + 1, c); d.rgb(x0 + 1, y0 + 1, e);
+        for (int k = 0; k < 3; ++k) out[k] = a[k] * w00 + b[k] * w01 + c[k] * w10 + e[k] * w11;
+    }
+};
+
+struct Nv12Reader : YuvReaderBase<Nv12Reader> {
+    const uint8_t *luma, *chroma;
+    size_t luma_stride, chroma_stride;
+    explicit Nv12Reader(const image_view_t &v)
+        : luma(v.plane[0]), chroma(v.plane[1]), luma_stride(v.stride[0]), chroma_stride(v.stride[1]) {}
+
+    void rgb(int x, int y, float *out) const {
+        const uint8_t *c = chroma + (y >> 1) * chroma_stride + (x & ~1);
+        yuv_to_rgb(luma[y * luma_stride + x], c[0], c[1], out);
+    }
+};
+
+struct Yuv420Reader : YuvReaderBase<Yuv420Reader> {
+    const uint8_t *luma, *cb, *cr;
+    size_t luma_stride, cb_stride, cr_stride;
+    explicit Yuv420Reader(const image_view_t &v)
+        : luma(v.plane[0]), cb(v.plane[1]), cr(v.plane[2]),
+          luma_stride(v.stride[0]), cb_stride(v.stride[1]), cr_stride(v.stride[2]) {}
+
+    void rgb(int x, int y, float *out) const {
+        const int cx = x >> 1, cy = y >> 1;
+        yuv_to_rgb(luma[y * luma_stride + x], cb[cy * cb_stride + cx], cr[cy * cr_stride + cx], out);
+    }
+};
+
+struct LinearTap {
+    int i0, i1;   // source indices
+    float w1;     // weight of i1, (1 - w1) goes to i0
+};
+
+// Same coordinate mapping and edge clamping as cv::resize(INTER_LINEAR).
+void build_taps(std::vector<LinearTap> &taps, int src_len, int dst_len) {
+    taps.resize(dst_len);
+    const float scale = (float)src_len / (float)dst_len;
+    for (int d = 0; d < dst_len; ++d) {
+        float f = (d + 0.5f) * scale - 0.5f;
+        int i0 = (int)std::floor(f);
+        float w1 = f - (float)i0;
+        if (i0 < 0) { i0 = 0; w1 = 0.0f; }
+        if (i0 >= src_len - 1) { i0 = src_len - 1; w1 = 0.0f; }
+        taps[d].i0 = i0;
+        taps[d].i1 = (i0 + 1 < src_len) ? i0 + 1 : i0;
+        taps[d].w1 = w1;
+    }
+}
+
+// Horizontal pass of source row y into an RGB float row, already scaled by gain.
+template<typename Reader>
+void resample_row(const Reader &src, int y, const std::vector<LinearTap> &xtaps, float gain, float *out) {
+    const int n = (int)xtaps.size();
+    for (int x = 0; x < n; ++x) {
+        float p0[3], p1[3];
+        src.rgb(xtaps[x].i0, y, p0);
+        src.rgb(xtaps[x].i1, y, p1);
+        const float w1 = xtaps[x].w1 * gain;
+        const float w0 = gain - w1;
+        out[0] = p0[0] * w0 + p1[0] * w1;
+        out[1] = p0[1] * w0 + p1[1] * w1;
+        out[2] = p0[2] * w0 + p1[2] * w1;
+        out += 3;
+    }
+}
+
+// dst = a * wa + b * wb, vectorized over the interleaved RGB row.
+void blend_rows(const float *a, const float *b, float wa, float wb, float *dst, int n) {
+    int i = 0;
+#if defined(PREPROCESS_NEON)
+    const float32x4_t va = vdupq_n_f32(wa);
+    const float32x4_t vb = vdupq_n_f32(wb);
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t r0 = vmulq_f32(vld1q_f32(a + i), va);
+        float32x4_t r1 = vmulq_f32(vld1q_f32(a + i + 4), va);
+        r0 = vmlaq_f32(r0, vld1q_f32(b + i), vb);
+        r1 = vmlaq_f32(r1, vld1q_f32(b + i + 4), vb);
+        vst1q_f32(dst + i, r0);
+        vst1q_f32(dst + i + 4, r1);
+    }
+#elif defined(PREPROCESS_SSE)
+    const __m128 va = _mm_set1_ps(wa);
+    const __m128 vb = _mm_set1_ps(wb);
+    for (; i + 8 <= n; i += 8) {
+        __m128 r0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), va), _mm_mul_ps(_mm_loadu_ps(b + i), vb));
+        __m128 r1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i + 4), va), _mm_mul_ps(_mm_loadu_ps(b + i + 4), vb));
+        _mm_storeu_ps(dst + i, r0);
+        _mm_storeu_ps(dst + i + 4, r1);
+    }
+#endif
+    for (; i < n; ++i) dst[i] = a[i] * wa + b[i] * wb;
+}
+
+template<typename Reader, typename T>
+void resize_impl(const Reader &src, int src_w, int src_h, bool mirror, T *dst, Affine8 map, int dst_w, int dst_h) {
+    static thread_local std::vector<LinearTap> xtaps, ytaps;
+    static thread_local std::vector<float> rows;
+    build_taps(xtaps, src_w, dst_w);
+    build_taps(ytaps, src_h, dst_h);
+    if (mirror) {
+        for (auto &t : xtaps) { t.i0 = src_w - 1 - t.i0; t.i1 = src_w - 1 - t.i1; }
+    }
+
+    const int row_len = dst_w * 3;
+    rows.resize(row_len * 3);
+    float *row0 = rows.data();
+    float *row1 = rows.data() + row_len;
+    float *staging = rows.data() + row_len * 2;
+    int cached0 = -1, cached1 = -1;
+
+    for (int y = 0; y < dst_h; ++y) {
+        const LinearTap &t = ytaps[y];
+        // Reuse horizontally resampled rows shared with the previous output row.
+        if (t.i0 != cached0) {
+            if (t.i0 == cached1) {
+                std::swap(row0, row1);
+                cached0 = cached1;
+                cached1 = -1;
+            } else {
+                resample_row(src, t.i0, xtaps, map.gain, row0);
+                cached0 = t.i0;
+            }
+        }
+        if (t.i1 != cached1) {
+            resample_row(src, t.i1, xtaps, map.gain, row1);
+            cached1 = t.i1;
+        }
+        T *out = dst + (size_t)y * row_len;
+        if constexpr (std::is_same<T, float>::value) {
+            blend_rows(row0, row1, 1.0f - t.w1, t.w1, out, row_len);
+        } else {
+            blend_rows(row0, row1, 1.0f - t.w1, t.w1, staging, row_len);
+            quantize_row(staging, out, row_len, map.bias);
+        }
+    }
+}
+
+// Range [u_begin, u_end) of u for which lo < a*u + b < hi, clipped to [0, n).
+void linear_span(float a, float b, float lo, float hi, int n, int &u_begin, int &u_end) {
+    if (a == 0.0f) {
+        bool inside = b > lo && b < hi;
+        u_begin = 0; u_end = inside ? n : 0;
+        return;
+    }
+    float u0 = (lo - b) / a, u1 = (hi - b) / a;
+    if (u0 > u1) std::swap(u0, u1);
+    u0 = std::min(std::max(u0, -1.0f), (float)n);
+    u1 = std::min(std::max(u1, -1.0f), (float)n);
+    // Widen by one pixel; the per-pixel edge test below is exact.
+    u_begin = std::max(0, (int)std::floor(u0));
+    u_end = std::min(n, (int)std::ceil(u1) + 1);
+    if (u_end < u_begin) u_end = u_begin;
+}
+
+template<typename Reader>
+inline void sample_edge(const Reader &src, int src_w, int src_h, float sx, float sy, float gain, float *rgb) {
+    const int x0 = (int)std::floor(sx), y0 = (int)std::floor(sy);
+    const float ax = sx - x0, ay = sy - y0;
+    const float w[4] = {(1 - ax) * (1 - ay), ax * (1 - ay), (1 - ax) * ay, ax * ay};
+    const int xs[4] = {x0, x0 + 1, x0, x0 + 1};
+    const int ys[4] = {y0, y0, y0 + 1, y0 + 1};
+    float r = 0, g = 0, b = 0;
+    for (int k = 0; k < 4; ++k) {
+        if (xs[k] < 0 || xs[k] >= src_w || ys[k] < 0 || ys[k] >= src_h) continue;
+        float p[3];
+        src.rgb(xs[k], ys[k], p);
+        r += p[0] * w[k]; g += p[1] * w[k]; b += p[2] * w[k];
+    }
+    rgb[0] = r * gain; rgb[1] = g * gain; rgb[2] = b * gain;
+}
+
+template<typename Reader, typename T>
+void warp_impl(const Reader &src, int src_w, int src_h, const float inv[6], T *dst, Affine8 map, int dst_w, int dst_h) {
+    const float k = map.gain;
+    const float xmax = (float)(src_w - 1), ymax = (float)(src_h - 1);
+    T zero;
+    put(&zero, map.bias);
+
+    for (int v = 0; v < dst_h; ++v) {
+        T *out = dst + (size_t)v * dst_w * 3;
+        const float bx = inv[1] * v + inv[2];
+        const float by = inv[4] * v + inv[5];
+
+        // Only pixels whose 2x2 footprint overlaps the frame need sampling.
+        int xb, xe, yb, ye;
+        linear_span(inv[0], bx, -1.0f, (float)src_w, dst_w, xb, xe);
+        linear_span(inv[3], by, -1.0f, (float)src_h, dst_w, yb, ye);
+        const int ub = std::max(xb, yb);
+        const int ue = std::max(ub, std::min(xe, ye));
+
+        std::fill(out, out + ub * 3, zero);
+        std::fill(out + ue * 3, out + dst_w * 3, zero);
+
+        for (int u = ub; u < ue; ++u) {
+            const float sx = inv[0] * u + bx;
+            const float sy = inv[3] * u + by;
+            float rgb[3];
+            if (sx >= 0.0f && sy >= 0.0f && sx < xmax && sy < ymax) {
+                const int x0 = (int)sx, y0 = (int)sy;
+                const float ax = sx - x0, ay = sy - y0;
+                const float w00 = (1 - ax) * (1 - ay) * k, w01 = ax * (1 - ay) * k;
+                const float w10 = (1 - ax) * ay * k, w11 = ax * ay * k;
+                src.bilinear(x0, y0, w00, w01, w10, w11, rgb);
+            } else {
+                sample_edge(src, src_w, src_h, sx, sy, k, rgb);
+            }
+            T *o = out + u * 3;
+            put(o + 0, rgb[0] + map.bias);
+            put(o + 1, rgb[1] + map.bias);
+            put(o + 2, rgb[2] + map.bias);
+        }
+    }
+}
+
+template<typename Reader>
+void resize_to(const Reader &src, const image_view_t &v, bool mirror, const tensor_dst_t &dst, int dst_w, int dst_h) {
+    const Affine8 map = output_mapping(dst);
+    switch (dst.type) {
+    case TENSOR_F32: resize_impl(src, v.width, v.height, mirror, (float *)dst.data, map, dst_w, dst_h); break;
+    case TENSOR_U8:  resize_impl(src, v.width, v.height, mirror, (uint8_t *)dst.data, map, dst_w, dst_h); break;
+    case TENSOR_I8:  resize_impl(src, v.width, v.height, mirror, (int8_t *)dst.data, map, dst_w, dst_h); break;
+    }
+}
+
+template<typename Reader>
+void warp_to(const Reader &src, const image_view_t &v, const float inv[6], const tensor_dst_t &dst, int dst_w, int dst_h) {
+    const Affine8 map = output_mapping(dst);
+    switch (dst.type) {
+    case TENSOR_F32: warp_impl(src, v.width, v.height, inv, (float *)dst.data, map, dst_w, dst_h); break;
+    case TENSOR_U8:  warp_impl(src, v.width, v.height, inv, (uint8_t *)dst.data, map, dst_w, dst_h); break;
+    case TENSOR_I8:  warp_impl(src, v.width, v.height, inv, (int8_t *)dst.data, map, dst_w, dst_h); break;
+    }
+}
+
+template<typename Reader>
+void to_bgr(const Reader &src, const image_view_t &v, uint8_t *dst, size_t dst_stride) {
+    for (int y = 0; y < v.height; ++y) {
+        uint8_t *o = dst + y * dst_stride;
+        for (int x = 0; x < v.width; ++x, o += 3) {
+            float rgb[3];
+            src.rgb(x, y, rgb);
+            o[0] = (uint8_t)std::lrint(rgb[2]);
+            o[1] = (uint8_t)std::lrint(rgb[1]);
+            o[2] = (uint8_t)std::lrint(rgb[0]);
+        }
+    }
+}
+
+} // namespace
+
+void resize_to_rgb(const image_view_t &src, bool mirror, const tensor_dst_t &dst, int dst_w, int dst_h) {
+    switch (src.format) {
+    case IMAGE_BGR888: resize_to(BgrReader(src), src, mirror, dst, dst_w, dst_h); break;
+    case IMAGE_NV12:   resize_to(Nv12Reader(src), src, mirror, dst, dst_w, dst_h); break;
+    case IMAGE_YUV420: resize_to(Yuv420Reader(src), src, mirror, dst, dst_w, dst_h); break;
+    }
+}
+
+void warp_affine_to_rgb(const image_view_t &src, const float inv[6], const tensor_dst_t &dst, int dst_w, int dst_h) {
+    switch (src.format) {
+    case IMAGE_BGR888: warp_to(BgrReader(src), src, inv, dst, dst_w, dst_h); break;
+    case IMAGE_NV12:   warp_to(Nv12Reader(src), src, inv, dst, dst_w, dst_h); break;
+    case IMAGE_YUV420: warp_to(Yuv420Reader(src), src, inv, dst, dst_w, dst_h); break;
+    }
+}
+
+void convert_to_bgr(const image_view_t &src, uint8_t *dst, size_t dst_stride) {
+    switch (src.format) {
+    case IMAGE_BGR888: to_bgr(BgrReader(src), src, dst, dst_stride); break;
+    case IMAGE_NV12:   to_bgr(Nv12Reader(src), src, dst, dst_stride); break;
+    case IMAGE_YUV420: to_bgr(Yuv420Reader(src), src, dst, dst_stride); break;
+    }
+}
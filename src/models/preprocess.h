@@ -0,0 +1,42 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../core/image_view.h"
+
+enum TensorElemType { TENSOR_F32, TENSOR_U8, TENSOR_I8 };
+
+// Model input the kernels write into. Float tensors receive RGB in [0,1];
+// 8-bit tensors receive round(v / scale + zero_point), so a uint8 input with
+// scale 1/255 gets plain pixel values and no float normalization.
+struct tensor_dst_t {
+    void *data;
+    TensorElemType type;
+    float scale;
+    int zero_point;
+
+    size_t elemSize() const { return type == TENSOR_F32 ? sizeof(float) : 1; }
+    tensor_dst_t offset(size_t elems) const {
+        tensor_dst_t d = *this;
+        d.data = (uint8_t *)data + elems * elemSize();
+        return d;
+    }
+};
+
+// Bilinear resize (same sampling grid as cv::resize INTER_LINEAR) of a frame
+// straight into an RGB input tensor. YUV frames are converted per sampled
+// pixel, so only what the output needs is ever converted.
+// Reads only the source rows the output needs; no intermediate images.
+// With mirror set the output is that of the horizontally flipped frame.
+void resize_to_rgb(const image_view_t &src, bool mirror, const tensor_dst_t &dst, int dst_w, int dst_h);
+
+// Bilinear sample of a frame through a dst->src affine map (2x3, row major)
+// into an RGB input tensor. Pixels that map outside the frame are written as
+// 0 (warpAffine BORDER_CONSTANT) without touching the source.
+void warp_affine_to_rgb(const image_view_t &src, const float inv[6], const tensor_dst_t &dst, int dst_w, int dst_h);
+
+// Whole frame to packed BGR888 (the preview; not for the per-frame path).
+void convert_to_bgr(const image_view_t &src, uint8_t *dst, size_t dst_stride);
+
+#endif
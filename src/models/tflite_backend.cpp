@@ -0,0 +1,97 @@
+#include "tflite_backend.h"
+#include <tensorflow/lite/kernels/register.h>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
+#include <sstream>
+#include <stdexcept>
+
+void TfLiteDelegateDeleter::operator()(TfLiteDelegate *d) const {
+    if (d) TfLiteXNNPackDelegateDelete(d);
+}
+
+static const char *typeName(TfLiteType type) {
+    switch (type) {
+    case kTfLiteFloat32: return "float32";
+    case kTfLiteUInt8: return "uint8";
+    case kTfLiteInt8: return "int8";
+    default: return "unsupported";
+    }
+}
+
+std::string buildInterpreter(const tflite::FlatBufferModel &model, InferenceBackend backend, bool fp16, int nthreads,
+                             std::unique_ptr<tflite::Interpreter> &interpreter, TfLiteDelegatePtr &delegate) {
+    // DEFAULT keeps whatever delegates this TFLite build applies on its own;
+    // CPU and XNNPACK start from the plain builtin kernels.
+    if (backend == InferenceBackend::DEFAULT) {
+        tflite::ops::builtin::BuiltinOpResolver resolver;
+        tflite::InterpreterBuilder(model, resolver)(&interpreter);
+    } else {
+        tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+        tflite::InterpreterBuilder(model, resolver)(&interpreter);
+    }
+    if (!interpreter) throw std::runtime_error("Failed to create interpreter");
+    interpreter->SetNumThreads(nthreads);
+    if (fp16) interpreter->SetAllowFp16PrecisionForFp32(true);
+
+    std::ostringstream desc;
+    desc << (backend == InferenceBackend::XNNPACK ? "XNNPACK" : backend == InferenceBackend::CPU ? "CPU" : "default")
+         << ", " << nthreads << " threads";
+
+    if (backend == InferenceBackend::XNNPACK) {
+        TfLiteXNNPackDelegateOptions opts = TfLiteXNNPackDelegateOptionsDefault();
+        opts.num_threads = nthreads;
+#ifdef TFLITE_XNNPACK_DELEGATE_FLAG_QS8
+        opts.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QS8 | TFLITE_XNNPACK_DELEGATE_FLAG_QU8;
+#endif
+        if (fp16) {
+#ifdef TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16
+            opts.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16;
+            desc << ", fp16";
+#else
+            desc << ", fp16 unsupported by this TFLite";
+#endif
+        }
+        delegate.reset(TfLiteXNNPackDelegateCreate(&opts));
+        if (!delegate || interpreter->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk)
+            throw std::runtime_error("Failed to apply XNNPACK delegate");
+    } else if (fp16) {
+        desc << ", fp16 allowed";
+    }
+
+    if (interpreter->AllocateTensors() != kTfLiteOk) throw std::runtime_error("Failed to allocate tensors");
+
+    const TfLiteTensor *in = interpreter->tensor(interpreter->inputs()[0]);
+    desc << ", input " << typeName(in->type);
+    if (in->type != kTfLiteFloat32) desc << " (scale " << in->params.scale << ", zero point " << in->params.zero_point << ")";
+    return desc.str();
+}
+
+tensor_dst_t inputTensorDst(tflite::Interpreter &interpreter, int tensor_index) {
+    TfLiteTensor *t = interpreter.tensor(tensor_index);
+    tensor_dst_t dst;
+    dst.data = t->data.raw;
+    dst.scale = t->params.scale;
+    dst.zero_point = t->params.zero_point;
+    switch (t->type) {
+    case kTfLiteFloat32: dst.type = TENSOR_F32; dst.scale = 1.0f; dst.zero_point = 0; break;
+    case kTfLiteUInt8: dst.type = TENSOR_U8; break;
+    case kTfLiteInt8: dst.type = TENSOR_I8; break;
+    default: throw std::runtime_error(std::string("Unsupported input tensor type ") + typeName(t->type));
+    }
+    if (dst.type != TENSOR_F32 && dst.scale <= 0.0f) throw std::runtime_error("Quantized input without scale");
+    return dst;
+}
+
+const float *outputAsFloat(const TfLiteTensor *tensor, std::vector<float> &buf) {
+    if (tensor->type == kTfLiteFloat32) return tensor->data.f;
+    const float scale = tensor->params.scale;
+    const int zp = tensor->params.zero_point;
+    buf.resize(tensor->bytes);
+    if (tensor->type == kTfLiteUInt8) {
+        for (size_t i = 0; i < tensor->bytes; ++i) buf[i] = (tensor->data.uint8[i] - zp) * scale;
+    } else if (tensor->type == kTfLiteInt8) {
+        for (size_t i = 0; i < tensor->bytes; ++i) buf[i] = (tensor->data.int8[i] - zp) * scale;
+    } else {
+        return nullptr;
+    }
+    return buf.data();
+}
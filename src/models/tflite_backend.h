@@ -0,0 +1,28 @@
+#ifndef TFLITE_BACKEND_H
+#define TFLITE_BACKEND_H
+
+#include "../core/types.h"
+#include "preprocess.h"
+#include <string>
+#include <memory>
+#include <vector>
+#include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/model.h>
+
+struct TfLiteDelegateDeleter { void operator()(TfLiteDelegate *d) const; };
+typedef std::unique_ptr<TfLiteDelegate, TfLiteDelegateDeleter> TfLiteDelegatePtr;
+
+// Builds an interpreter for model on the requested backend and allocates its
+// tensors. The delegate (if any) must outlive the interpreter. Returns a
+// one-line description of the active execution path.
+std::string buildInterpreter(const tflite::FlatBufferModel &model, InferenceBackend backend, bool fp16, int nthreads,
+                             std::unique_ptr<tflite::Interpreter> &interpreter, TfLiteDelegatePtr &delegate);
+
+// Input tensor as a destination for the preprocessing kernels.
+tensor_dst_t inputTensorDst(tflite::Interpreter &interpreter, int tensor_index);
+
+// Output tensor as floats: float tensors are used in place, 8-bit ones are
+// dequantized into buf. nullptr for any other type.
+const float *outputAsFloat(const TfLiteTensor *tensor, std::vector<float> &buf);
+
+#endif
@@ -3,14 +3,27 @@
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
 #include <iostream>
 #include <sys/ioctl.h>
 
-MouseController::MouseController() : fd(-1) {}
+MouseController::MouseController()
+    : fd(-1), owns_fd(false), npending(0), unsynced(false), last_x(-1), last_y(-1),
+      write_errors(0), short_writes(0) {}
 MouseController::~MouseController() { if (fd >= 0) destroy(); }
 
+void MouseController::attach(int new_fd) {
+    if (fd >= 0) destroy();
+    fd = new_fd;
+    owns_fd = false;
+    npending = 0;
+    unsynced = false;
+    last_x = last_y = -1;
+}
+
 bool MouseController::init() {
     fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    owns_fd = true;
     if (fd < 0) {
         std::cerr << "ERR: Cannot open /dev/uinput. Try sudo.\n";
         return false;
@@ -53,10 +66,44 @@ bool MouseController::init() {
 
 void MouseController::emit(int type, int code, int val) {
     if (fd < 0) return;
-    struct input_event ie;
+    if (npending == kMaxPending) flush();
+    struct input_event &ie = pending[npending++];
     memset(&ie, 0, sizeof(ie));
     ie.type = type; ie.code = code; ie.value = val;
-    write(fd, &ie, sizeof(ie));
+    unsynced = true;
+}
+
+void MouseController::sync() {
+    if (unsynced) emit(EV_SYN, SYN_REPORT, 0);
+    unsynced = false;
+}
+
+bool MouseController::flush() {
+    if (fd < 0 || npending == 0) return true;
+    const char *p = (const char *)pending;
+    size_t left = npending * sizeof(struct input_event);
+    npending = 0;
+    bool cut = false;
+    while (left > 0) {
+        ssize_t n = write(fd, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            // Report the first failure; the count tells the rest.
+            if (write_errors++ == 0) std::cerr << "ERR: mouse event write failed: " << strerror(errno) << "\n";
+            // The position may not have arrived; resend both axes next time.
+            last_x = last_y = -1;
+            return false;
+        }
+        if ((size_t)n < left) cut = true;
+        p += n;
+        left -= n;
+    }
+    if (cut) {
+        if (short_writes++ == 0) std::cerr << "WARN: mouse event batch written in pieces\n";
+        last_x = last_y = -1;
+        return false;
+    }
+    return true;
 }
 
 void MouseController::move_absolute(int x, int y) {
@@ -64,32 +111,36 @@ void MouseController::move_absolute(int x, int y) {
     if (x < 0) x = 0; if (y < 0) y = 0;
     if (x > SCREEN_WIDTH) x = SCREEN_WIDTH;
     if (y > SCREEN_HEIGHT) y = SCREEN_HEIGHT;
-    emit(EV_ABS, ABS_X, x);
-    emit(EV_ABS, ABS_Y, y);
-    emit(EV_SYN, SYN_REPORT, 0);
+    if (x != last_x) { emit(EV_ABS, ABS_X, x); last_x = x; }
+    if (y != last_y) { emit(EV_ABS, ABS_Y, y); last_y = y; }
+    sync();
 }
 
 void MouseController::click_right() {
     if (fd < 0) return;
-    emit(EV_KEY, BTN_RIGHT, 1); emit(EV_SYN, SYN_REPORT, 0);
-    emit(EV_KEY, BTN_RIGHT, 0); emit(EV_SYN, SYN_REPORT, 0);
+    emit(EV_KEY, BTN_RIGHT, 1); sync();
+    emit(EV_KEY, BTN_RIGHT, 0); sync();
 }
 
 void MouseController::press_left() {
     if (fd < 0) return;
     emit(EV_KEY, BTN_LEFT, 1);   
-    emit(EV_SYN, SYN_REPORT, 0);
+    sync();
 }
 
 void MouseController::release_left() {
     if (fd < 0) return;
     emit(EV_KEY, BTN_LEFT, 0);   
-    emit(EV_SYN, SYN_REPORT, 0);
+    sync();
 }
 
 void MouseController::destroy() {
     if (fd >= 0) {
-        ioctl(fd, UI_DEV_DESTROY);
-        close(fd); fd = -1;
+        flush();
+        if (owns_fd) {
+            ioctl(fd, UI_DEV_DESTROY);
+            close(fd);
+        }
+        fd = -1;
     }
 }
@@ -2,12 +2,18 @@
 #define MOUSE_CONTROL_H
 
 #include <linux/uinput.h>
+#include <stdint.h>
 
+// Virtual absolute mouse. Events are queued and go out in one write() per
+// flush(); position updates that do not change an axis are dropped.
 class MouseController {
 public:
     MouseController();
     ~MouseController();
     bool init();
+    // Writes to an already open descriptor (a pipe or file) instead of
+    // creating a uinput device; the caller keeps ownership of fd.
+    void attach(int fd);
     void destroy();
     void move_absolute(int x, int y);
     
@@ -15,8 +21,22 @@ public:
     void press_left();   
     void release_left(); 
 
+    // Sends the queued events; false if the write failed or was cut short.
+    bool flush();
+    uint64_t writeErrors() const { return write_errors; }
+    uint64_t shortWrites() const { return short_writes; }
+
 private:
+    static const int kMaxPending = 32;
     int fd;
+    bool owns_fd;
+    struct input_event pending[kMaxPending];
+    int npending;
+    bool unsynced;
+    int last_x, last_y;
+    uint64_t write_errors;
+    uint64_t short_writes;
     void emit(int type, int code, int val);
+    void sync();
 };
-#endif
\ No newline at end of file
+#endif
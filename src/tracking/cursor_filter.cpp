@@ -0,0 +1,77 @@
+#include "cursor_filter.h"
+#include <cmath>
+
+static float smoothing_alpha(float cutoff, float dt) {
+    const float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+fvec2 OneEuroFilter::update(fvec2 p, double t_sec) {
+    float dt = (float)(t_sec - t_);
+    if (!have_ || dt <= 0.0f || dt > 0.5f) {
+        // First sample, or a gap long enough that the old state is stale.
+        have_ = true;
+        t_ = t_sec;
+        x_ = p;
+        dx_ = {0.0f, 0.0f};
+        return p;
+    }
+    t_ = t_sec;
+
+    const float ad = smoothing_alpha(d_cutoff_, dt);
+    dx_.x += ad * ((p.x - x_.x) / dt - dx_.x);
+    dx_.y += ad * ((p.y - x_.y) / dt - dx_.y);
+
+    // One cutoff for both axes, from the 2D speed.
+    const float speed = std::sqrt(dx_.x * dx_.x + dx_.y * dx_.y);
+    const float a = smoothing_alpha(min_cutoff_ + beta_ * speed, dt);
+    x_.x += a * (p.x - x_.x);
+    x_.y += a * (p.y - x_.y);
+    return x_;
+}
+
+void KalmanCursorFilter::step(Axis &s, float z, float dt) {
+    // Predict: x += v*dt, P = F P F' + Q (continuous white acceleration).
+    s.x += s.v * dt;
+    const float dt2 = dt * dt, dt3 = dt2 * dt;
+    const float pxx = s.pxx + dt * (2.0f * s.pxv + dt * s.pvv) + q_ * dt3 / 3.0f;
+    const float pxv = s.pxv + dt * s.pvv + q_ * dt2 / 2.0f;
+    const float pvv = s.pvv + q_ * dt;
+
+    // Correct with the position measurement.
+    const float inv_s = 1.0f / (pxx + r_);
+    const float kx = pxx * inv_s, kv = pxv * inv_s;
+    const float y = z - s.x;
+    s.x += kx * y;
+    s.v += kv * y;
+    s.pxx = (1.0f - kx) * pxx;
+    s.pxv = (1.0f - kx) * pxv;
+    s.pvv = pvv - kv * pxv;
+}
+
+fvec2 KalmanCursorFilter::update(fvec2 p, double t_sec) {
+    float dt = (float)(t_sec - t_);
+    if (!have_ || dt <= 0.0f || dt > 0.5f) {
+        have_ = true;
+        t_ = t_sec;
+        // Unknown velocity: start with a wide velocity variance.
+        axis_[0] = {p.x, 0.0f, r_, 0.0f, 1e6f};
+        axis_[1] = {p.y, 0.0f, r_, 0.0f, 1e6f};
+        return p;
+    }
+    t_ = t_sec;
+    step(axis_[0], p.x, dt);
+    step(axis_[1], p.y, dt);
+    return {axis_[0].x, axis_[1].x};
+}
+
+std::unique_ptr<CursorFilter> makeCursorFilter(CursorFilterType type) {
+    switch (type) {
+    case CursorFilterType::ONE_EURO:
+        return std::unique_ptr<CursorFilter>(new OneEuroFilter(ONE_EURO_MIN_CUTOFF, ONE_EURO_BETA, ONE_EURO_D_CUTOFF));
+    case CursorFilterType::KALMAN:
+        return std::unique_ptr<CursorFilter>(new KalmanCursorFilter(KALMAN_ACCEL_NOISE, KALMAN_MEAS_NOISE));
+    default:
+        return std::unique_ptr<CursorFilter>(new PassthroughFilter);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef CURSOR_FILTER_H
+#define CURSOR_FILTER_H
+
+#include "../core/types.h"
+#include <memory>
+
+// Smooths the cursor point of one hand. update() takes the measured point
+// and its capture time; velocity() goes out with the cursor target, and
+// CursorWorker extrapolates from it to hide the camera-to-cursor latency.
+class CursorFilter {
+public:
+    virtual ~CursorFilter() {}
+    virtual void reset() = 0;
+    virtual fvec2 update(fvec2 p, double t_sec) = 0;
+    virtual fvec2 velocity() const = 0;   // per second
+};
+
+class PassthroughFilter : public CursorFilter {
+public:
+    void reset() override {}
+    fvec2 update(fvec2 p, double) override { return p; }
+    fvec2 velocity() const override { return {0.0f, 0.0f}; }
+};
+
+// One-Euro filter (Casiez et al.): the cutoff rises with speed, so slow
+// motion is smoothed hard and fast motion lags little.
+class OneEuroFilter : public CursorFilter {
+public:
+    OneEuroFilter(float min_cutoff, float beta, float d_cutoff)
+        : min_cutoff_(min_cutoff), beta_(beta), d_cutoff_(d_cutoff) {}
+    void reset() override { have_ = false; }
+    fvec2 update(fvec2 p, double t_sec) override;
+    fvec2 velocity() const override { return dx_; }
+
+private:
+    float min_cutoff_, beta_, d_cutoff_;
+    bool have_ = false;
+    double t_ = 0.0;
+    fvec2 x_ = {0.0f, 0.0f};
+    fvec2 dx_ = {0.0f, 0.0f};
+};
+
+// Constant-velocity Kalman filter, one [position, velocity] state per axis.
+class KalmanCursorFilter : public CursorFilter {
+public:
+    // accel_noise: px/s^2 (white acceleration); meas_noise: px (landmark jitter)
+    KalmanCursorFilter(float accel_noise, float meas_noise)
+        : q_(accel_noise * accel_noise), r_(meas_noise * meas_noise) {}
+    void reset() override { have_ = false; }
+    fvec2 update(fvec2 p, double t_sec) override;
+    fvec2 velocity() const override { return {axis_[0].v, axis_[1].v}; }
+
+private:
+    struct Axis { float x, v, pxx, pxv, pvv; };
+    void step(Axis &a, float z, float dt);
+
+    float q_, r_;
+    bool have_ = false;
+    double t_ = 0.0;
+    Axis axis_[2];
+};
+
+std::unique_ptr<CursorFilter> makeCursorFilter(CursorFilterType type);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "hand_tracker.h"
+#include "roi_tracker.h"
+#include <cmath>
+#include <algorithm>
+
+bool HandTracker::sameHand(const HandRoi &a, const HandRoi &b, int img_w, int img_h) {
+    float dx = (a.xc - b.xc) * img_w;
+    float dy = (a.yc - b.yc) * img_h;
+    float size = std::min(std::max(a.w * img_w, a.h * img_h), std::max(b.w * img_w, b.h * img_h));
+    return std::sqrt(dx * dx + dy * dy) < size * 0.5f;
+}
+
+void HandTracker::addCandidates(const palm_detection_result_t &palms, int img_w, int img_h) {
+    for (int i = 0; i < palms.num && !full(); ++i) {
+        HandRoi roi;
+        RoiTracker::calculateRoiFromPalm(palms.palms[i], roi);
+        bool known = false;
+        for (const auto &t : tracks_) {
+            if (sameHand(t.roi, roi, img_w, img_h)) { known = true; break; }
+        }
+        if (known) continue;
+        HandTrack t;
+        t.id = next_id_++;
+        t.roi = roi;
+        t.confirmed = false;
+        t.frames = 0;
+        tracks_.push_back(t);
+    }
+}
+
+void HandTracker::collectRois(std::vector<HandRoi> &rois) const {
+    rois.clear();
+    for (const auto &t : tracks_) rois.push_back(t.roi);
+}
+
+void HandTracker::update(std::vector<hand_landmark_result_t> &results, int img_w, int img_h) {
+    size_t kept = 0;
+    for (size_t i = 0; i < tracks_.size() && i < results.size(); ++i) {
+        HandTrack &t = tracks_[i];
+        hand_landmark_result_t &res = results[i];
+        float thresh = t.confirmed ? THRESH_TRACK_EXIT : THRESH_TRACK_ENTER;
+        if (res.score <= thresh) continue;
+
+        if (res.score > 0.5f) RoiTracker::calculateRoiFromLandmarks(res, t.roi, img_w, img_h);
+        t.confirmed = true;
+        t.frames++;
+        res.hand_id = t.id;
+
+        // Two tracks that converged on one hand: the older one keeps it.
+        bool duplicate = false;
+        for (size_t k = 0; k < kept; ++k) {
+            if (sameHand(tracks_[k].roi, t.roi, img_w, img_h)) { duplicate = true; break; }
+        }
+        if (duplicate) continue;
+
+        if (kept != i) {
+            tracks_[kept] = t;
+            results[kept] = res;
+        }
+        kept++;
+    }
+    tracks_.resize(kept);
+    results.resize(kept);
+}
+
+const HandTrack *HandTracker::primary() const {
+    for (const auto &t : tracks_) {
+        if (t.confirmed) return &t;
+    }
+    return nullptr;
+}
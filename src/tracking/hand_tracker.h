@@ -0,0 +1,39 @@
+#ifndef HAND_TRACKER_H
+#define HAND_TRACKER_H
+
+#include "../core/types.h"
+#include <vector>
+
+struct HandTrack {
+    int id;
+    HandRoi roi;
+    bool confirmed;     // passed THRESH_TRACK_ENTER at least once
+    uint32_t frames;
+};
+
+// Up to MAX_HAND_NUM hands, each with its own ROI and an id that stays with
+// the hand across frames.
+class HandTracker {
+public:
+    int count() const { return (int)tracks_.size(); }
+    bool full() const { return count() >= MAX_HAND_NUM; }
+    const std::vector<HandTrack> &tracks() const { return tracks_; }
+
+    // Palm detections that do not overlap a tracked hand become tentative tracks.
+    void addCandidates(const palm_detection_result_t &palms, int img_w, int img_h);
+    // One ROI per track, in track order.
+    void collectRois(std::vector<HandRoi> &rois) const;
+    // Takes landmark results in collectRois() order, drops lost hands and keeps
+    // only the results of surviving tracks (tagged with their hand_id).
+    void update(std::vector<hand_landmark_result_t> &results, int img_w, int img_h);
+    // Oldest confirmed track, the one that drives the cursor.
+    const HandTrack *primary() const;
+    void clear() { tracks_.clear(); }
+
+private:
+    static bool sameHand(const HandRoi &a, const HandRoi &b, int img_w, int img_h);
+    std::vector<HandTrack> tracks_;
+    int next_id_ = 0;
+};
+
+#endif
@@ -33,4 +33,11 @@ void RoiTracker::calculateRoiFromLandmarks(const hand_landmark_result_t& res, Ha
     raw_roi.h = size / img_h;
     raw_roi.rotation = rotation;
     raw_roi.isValid = true;
+}
+
+void RoiTracker::calculateRoiFromPalm(const palm_t& palm, HandRoi& roi) {
+    roi.xc = palm.hand_cx; roi.yc = palm.hand_cy;
+    roi.w = palm.hand_w; roi.h = palm.hand_h;
+    roi.rotation = palm.rotation;
+    roi.isValid = true;
 }
\ No newline at end of file
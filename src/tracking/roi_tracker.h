@@ -6,6 +6,7 @@
 class RoiTracker {
 public:
     static void calculateRoiFromLandmarks(const hand_landmark_result_t& res, HandRoi& raw_roi, int img_w, int img_h);
+    static void calculateRoiFromPalm(const palm_t& palm, HandRoi& roi);
 };
 
 #endif
\ No newline at end of file